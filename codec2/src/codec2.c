@@ -171,6 +171,24 @@ struct CODEC2 * codec2_create(int mode)
 	return NULL;
     }
 
+    /* work space for per frame temporaries, sized for the largest user:
+       the windowed speech in speech_to_uq_lsps() or the phase synthesis
+       in determine_phase() */
+
+    int nscratch = m_pitch;
+    if (DETERMINE_PHASE_SCRATCH(NEWAMP1_PHASE_NFFT) > nscratch)
+        nscratch = DETERMINE_PHASE_SCRATCH(NEWAMP1_PHASE_NFFT);
+    if (DETERMINE_PHASE_SCRATCH(NEWAMP2_PHASE_NFFT) > nscratch)
+        nscratch = DETERMINE_PHASE_SCRATCH(NEWAMP2_PHASE_NFFT);
+    c2->scratch = (float*)MALLOC(nscratch*sizeof(float));
+    if (c2->scratch == NULL) {
+        FREE(c2->Pn);
+        FREE(c2->Sn_);
+        FREE(c2->w);
+        FREE(c2->Sn);
+	return NULL;
+    }
+
     for(i=0; i<m_pitch; i++)
 	c2->Sn[i] = 1.0;
     c2->hpf_states[0] = c2->hpf_states[1] = 0.0;
@@ -234,6 +252,8 @@ struct CODEC2 * codec2_create(int mode)
         c2->voicing_left = 0;;
         c2->phase_fft_fwd_cfg = codec2_fft_alloc(NEWAMP1_PHASE_NFFT, 0, NULL, NULL);
         c2->phase_fft_inv_cfg = codec2_fft_alloc(NEWAMP1_PHASE_NFFT, 1, NULL, NULL);
+        c2->mbest_stage1 = mbest_create(NEWAMP1_VQ_MBEST_DEPTH);
+        c2->mbest_stage2 = mbest_create(NEWAMP1_VQ_MBEST_DEPTH);
     }
 
     /* newamp2 initialisation */
@@ -248,6 +268,7 @@ struct CODEC2 * codec2_create(int mode)
         c2->voicing_left = 0;;
         c2->phase_fft_fwd_cfg = codec2_fft_alloc(NEWAMP2_PHASE_NFFT, 0, NULL, NULL);
         c2->phase_fft_inv_cfg = codec2_fft_alloc(NEWAMP2_PHASE_NFFT, 1, NULL, NULL);
+        c2->mbest_stage1 = mbest_create(1);
     }
     /* newamp2 PWB initialisation */
 
@@ -261,6 +282,7 @@ struct CODEC2 * codec2_create(int mode)
         c2->voicing_left = 0;;
         c2->phase_fft_fwd_cfg = codec2_fft_alloc(NEWAMP2_PHASE_NFFT, 0, NULL, NULL);
         c2->phase_fft_inv_cfg = codec2_fft_alloc(NEWAMP2_PHASE_NFFT, 1, NULL, NULL);
+        c2->mbest_stage1 = mbest_create(1);
     }
 
     c2->fmlfeat = NULL; c2->fmlmodel = NULL;
@@ -352,18 +374,23 @@ void codec2_destroy(struct CODEC2 *c2)
     if ( CODEC2_MODE_ACTIVE(CODEC2_MODE_700C, c2->mode)) {
         codec2_fft_free(c2->phase_fft_fwd_cfg);
         codec2_fft_free(c2->phase_fft_inv_cfg);
+        mbest_destroy(c2->mbest_stage1);
+        mbest_destroy(c2->mbest_stage2);
     }
     if ( CODEC2_MODE_ACTIVE(CODEC2_MODE_450, c2->mode)) {
         codec2_fft_free(c2->phase_fft_fwd_cfg);
         codec2_fft_free(c2->phase_fft_inv_cfg);
+        mbest_destroy(c2->mbest_stage1);
     }
     if ( CODEC2_MODE_ACTIVE(CODEC2_MODE_450PWB, c2->mode)) {
         codec2_fft_free(c2->phase_fft_fwd_cfg);
         codec2_fft_free(c2->phase_fft_inv_cfg);
+        mbest_destroy(c2->mbest_stage1);
     }
     FREE(c2->Pn);
     FREE(c2->Sn);
     FREE(c2->w);
+    FREE(c2->scratch);
     FREE(c2->Sn_);
     FREE(c2);
 }
@@ -517,7 +544,7 @@ void codec2_encode_3200(struct CODEC2 *c2, unsigned char * bits, short speech[])
     Wo_index = encode_Wo(&c2->c2const, model.Wo, WO_BITS);
     pack(bits, &nbit, Wo_index, WO_BITS);
 
-    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD);
+    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD, c2->scratch);
     e_index = encode_energy(e, E_BITS);
     pack(bits, &nbit, e_index, E_BITS);
 
@@ -661,7 +688,7 @@ void codec2_encode_2400(struct CODEC2 *c2, unsigned char * bits, short speech[])
     analyse_one_frame(c2, &model, &speech[c2->n_samp]);
     pack(bits, &nbit, model.voiced, 1);
 
-    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD);
+    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD, c2->scratch);
     WoE_index = encode_WoE(&model, e, c2->xq_enc);
     pack(bits, &nbit, WoE_index, WO_E_BITS);
 
@@ -822,7 +849,7 @@ void codec2_encode_1600(struct CODEC2 *c2, unsigned char * bits, short speech[])
     pack(bits, &nbit, Wo_index, WO_BITS);
 
     /* need to run this just to get LPC energy */
-    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD);
+    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD, c2->scratch);
     e_index = encode_energy(e, E_BITS);
     pack(bits, &nbit, e_index, E_BITS);
 
@@ -839,7 +866,7 @@ void codec2_encode_1600(struct CODEC2 *c2, unsigned char * bits, short speech[])
     Wo_index = encode_Wo(&c2->c2const, model.Wo, WO_BITS);
     pack(bits, &nbit, Wo_index, WO_BITS);
 
-    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD);
+    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD, c2->scratch);
     e_index = encode_energy(e, E_BITS);
     pack(bits, &nbit, e_index, E_BITS);
 
@@ -1002,7 +1029,7 @@ void codec2_encode_1400(struct CODEC2 *c2, unsigned char * bits, short speech[])
     pack(bits, &nbit, model.voiced, 1);
 
     /* need to run this just to get LPC energy */
-    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD);
+    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD, c2->scratch);
 
     WoE_index = encode_WoE(&model, e, c2->xq_enc);
     pack(bits, &nbit, WoE_index, WO_E_BITS);
@@ -1017,7 +1044,7 @@ void codec2_encode_1400(struct CODEC2 *c2, unsigned char * bits, short speech[])
     analyse_one_frame(c2, &model, &speech[3*c2->n_samp]);
     pack(bits, &nbit, model.voiced, 1);
 
-    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD);
+    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD, c2->scratch);
     WoE_index = encode_WoE(&model, e, c2->xq_enc);
     pack(bits, &nbit, WoE_index, WO_E_BITS);
 
@@ -1191,7 +1218,7 @@ void codec2_encode_1300(struct CODEC2 *c2, unsigned char * bits, short speech[])
     //#ifdef PROFILE
     //quant_start = machdep_profile_sample();
     //#endif
-    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD);
+    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD, c2->scratch);
     e_index = encode_energy(e, E_BITS);
     pack_natural_or_gray(bits, &nbit, e_index, E_BITS, c2->gray);
 
@@ -1384,7 +1411,7 @@ void codec2_encode_1200(struct CODEC2 *c2, unsigned char * bits, short speech[])
     pack(bits, &nbit, model.voiced, 1);
 
     /* need to run this just to get LPC energy */
-    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD);
+    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD, c2->scratch);
 
     WoE_index = encode_WoE(&model, e, c2->xq_enc);
     pack(bits, &nbit, WoE_index, WO_E_BITS);
@@ -1399,7 +1426,7 @@ void codec2_encode_1200(struct CODEC2 *c2, unsigned char * bits, short speech[])
     analyse_one_frame(c2, &model, &speech[3*c2->n_samp]);
     pack(bits, &nbit, model.voiced, 1);
 
-    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD);
+    e = speech_to_uq_lsps(lsps, ak, c2->Sn, c2->w, c2->m_pitch, LPC_ORD, c2->scratch);
     WoE_index = encode_WoE(&model, e, c2->xq_enc);
     pack(bits, &nbit, WoE_index, WO_E_BITS);
 
@@ -1560,7 +1587,8 @@ void codec2_encode_700c(struct CODEC2 *c2, unsigned char * bits, short speech[])
                              K,
                              &mean,
                              rate_K_vec_no_mean,
-                             rate_K_vec_no_mean_, &c2->se, c2->eq, c2->eq_en);
+                             rate_K_vec_no_mean_, &c2->se, c2->eq, c2->eq_en,
+                             c2->mbest_stage1, c2->mbest_stage2);
     c2->nse += K;
 
 #ifndef CORTEX_M4
@@ -1632,7 +1660,8 @@ void codec2_decode_700c(struct CODEC2 *c2, short speech[], const unsigned char *
                              c2->phase_fft_inv_cfg,
                              indexes,
                              c2->user_rate_K_vec_no_mean_,
-                             c2->post_filter_en);
+                             c2->post_filter_en,
+                             c2->scratch);
 
 
    for(i=0; i<M; i++) {
@@ -1882,7 +1911,8 @@ void codec2_encode_450(struct CODEC2 *c2, unsigned char * bits, short speech[])
                              &mean,
                              rate_K_vec_no_mean,
                              rate_K_vec_no_mean_,
-                             plosiv);
+                             plosiv,
+                             c2->mbest_stage1);
 
                              
 	pack_natural_or_gray(bits, &nbit, indexes[0], 9, 0);
@@ -1937,7 +1967,8 @@ void codec2_decode_450(struct CODEC2 *c2, short speech[], const unsigned char *
                              c2->phase_fft_inv_cfg,
                              indexes,
                              1.5,
-                             pwbFlag);
+                             pwbFlag,
+                             c2->scratch);
 
 
    for(i=0; i<M; i++) {
@@ -1990,7 +2021,8 @@ void codec2_decode_450pwb(struct CODEC2 *c2, short speech[], const unsigned char
                              c2->phase_fft_inv_cfg,
                              indexes,
                              1.5,
-                             pwbFlag);
+                             pwbFlag,
+                             c2->scratch);
 
 
    for(i=0; i<M; i++) {
@@ -2255,11 +2287,8 @@ void codec2_load_codebook(struct CODEC2 *codec2_state, int num, char *filename)
 	exit(1);
     }
     //fprintf(stderr, "reading newamp1vq_cb[%d] k=%d m=%d\n", num, newamp1vq_cb[num].k, newamp1vq_cb[num].m);
-    float tmp[newamp1vq_cb[num].k*newamp1vq_cb[num].m];
-    int nread = fread(tmp, sizeof(float), newamp1vq_cb[num].k*newamp1vq_cb[num].m, f);
     float *p = (float*)newamp1vq_cb[num].cb;
-    for(int i=0; i<newamp1vq_cb[num].k*newamp1vq_cb[num].m; i++)
-       p[i] = tmp[i];
+    int nread = fread(p, sizeof(float), newamp1vq_cb[num].k*newamp1vq_cb[num].m, f);
     // fprintf(stderr, "nread = %d %f %f\n", nread, newamp1vq_cb[num].cb[0], newamp1vq_cb[num].cb[1]);
     assert(nread == newamp1vq_cb[num].k*newamp1vq_cb[num].m);
     fclose(f);
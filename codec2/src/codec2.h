@@ -113,6 +113,21 @@ float *codec2_enable_user_ratek(struct CODEC2 *codec2_state, int *K);
 // 700C post filter and equaliser
 void codec2_700c_post_filter(struct CODEC2 *codec2_state, int en);
 void codec2_700c_eq(struct CODEC2 *codec2_state, int en);
+
+// offline encoding of long recordings split over threads, see codec2_segment.c
+#define CODEC2_SEGMENT_MIN_FRAMES 50    // frames per segment below which fewer segments are used
+#define CODEC2_SEGMENT_WARMUP     16    // frames encoded before each segment to prime the encoder states
+
+struct codec2_segment_report {
+    int  nsegments;                     // segments used
+    int  frames_differ;                 // frames whose bits differ from a sequential encode
+    long bits_differ;                   // total bits that differ
+    int  max_settle;                    // most frames from a segment start to its last difference
+};
+
+int codec2_encode_segmented(int mode, int gray, unsigned char bits[], short speech[],
+                            int nframes, int nsegments, int nwarmup,
+                            struct codec2_segment_report *report);
       
 #ifdef __cplusplus
 }
@@ -46,6 +46,7 @@ struct CODEC2 {
     float        *Pn;	                   /* [2*n_samp] trapezoidal synthesis window   */
     float        *bpf_buf;                 /* buffer for band pass filter               */
     float        *Sn;                      /* [m_pitch] input speech                    */
+    float        *scratch;                 /* per frame work space, see codec2_create() */
     float         hpf_states[2];           /* high pass filter states                   */
     void         *nlp;                     /* pitch predictor states                    */
     int           gray;                    /* non-zero for gray encoding                */
@@ -84,6 +85,8 @@ struct CODEC2 {
     int            post_filter_en;
     float          eq[NEWAMP1_K];            /* optional equaliser */
     int            eq_en;
+    struct MBEST  *mbest_stage1;             /* mbest VQ search lists, reused every frame */
+    struct MBEST  *mbest_stage2;
     
     /*newamp2 states (also uses newamp1 states )*/
     float 	   energy_prev;
@@ -0,0 +1,286 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: codec2_segment.c
+  DATE CREATED: Oct 2026
+
+  Offline encoding of long recordings split into segments that are
+  encoded in parallel, one codec instance and thread per segment.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "defines.h"
+#include "codec2.h"
+#include "codec2_internal.h"
+
+struct segment {
+    struct CODEC2 *c2;
+    short         *speech;      /* first warm up frame                        */
+    unsigned char *bits;        /* first frame of the segment                 */
+    float         *xq;          /* [2*nframes] xq_enc after each frame        */
+    float          xq0[2];      /* xq_enc after the warm up                   */
+    int            nwarmup;     /* frames encoded and discarded               */
+    int            nframes;     /* frames of the segment                      */
+    int            nsam;
+    int            nbyte;
+    pthread_t      thread;
+    int            started;
+};
+
+static void segment_warmup(struct segment *s, struct CODEC2 *c2)
+{
+    unsigned char discard[s->nbyte];
+    int           i;
+
+    for(i=0; i<s->nwarmup; i++)
+	codec2_encode(c2, discard, &s->speech[i*s->nsam]);
+}
+
+static void *segment_encode(void *arg)
+{
+    struct segment *s = arg;
+    short          *speech = &s->speech[s->nwarmup*s->nsam];
+    int             i;
+
+    segment_warmup(s, s->c2);
+    memcpy(s->xq0, s->c2->xq_enc, sizeof(s->xq0));
+
+    for(i=0; i<s->nframes; i++) {
+	codec2_encode(s->c2, &s->bits[i*s->nbyte], &speech[i*s->nsam]);
+	memcpy(&s->xq[2*i], s->c2->xq_enc, sizeof(s->xq0));
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: segment_stitch
+  DATE CREATED: Oct 2026
+
+  The warm up primes the states that depend only on recent input
+  speech (Sn[], nlp, previous pitch), but not xq_enc[], the joint Wo
+  and energy predictor of the 2400, 1400 and 1200 modes.  It feeds
+  back its own quantised output, so two encoders that start it from
+  different values produce different bits until float round off makes
+  them equal, ~150 frames later.
+
+  So going through the boundaries in order, segment s is encoded again
+  from the xq_enc[] the previous segment ended with, until xq_enc[]
+  matches the value it had in the parallel encode.  As nothing else
+  depends on xq_enc[], the rest of the segment is then unchanged.  For
+  the other modes xq_enc[] is always zero and nothing is encoded.
+
+  Returns -1 if a codec instance could not be created.
+
+\*---------------------------------------------------------------------------*/
+
+static int segment_stitch(int mode, int gray, struct segment seg[], int nsegments)
+{
+    struct CODEC2 *c2;
+    const float   *xq;
+    short         *speech;
+    int            s, i;
+
+    for(s=1; s<nsegments; s++) {
+	xq = &seg[s-1].xq[2*(seg[s-1].nframes-1)];
+	if (memcmp(xq, seg[s].xq0, sizeof(seg[s].xq0)) == 0)
+	    continue;
+
+	c2 = codec2_create(mode);
+	if (c2 == NULL)
+	    return -1;
+	codec2_set_natural_or_gray(c2, gray);
+
+	segment_warmup(&seg[s], c2);
+	memcpy(c2->xq_enc, xq, sizeof(seg[s].xq0));
+
+	speech = &seg[s].speech[seg[s].nwarmup*seg[s].nsam];
+	for(i=0; i<seg[s].nframes; i++) {
+	    codec2_encode(c2, &seg[s].bits[i*seg[s].nbyte], &speech[i*seg[s].nsam]);
+	    if (memcmp(&seg[s].xq[2*i], c2->xq_enc, sizeof(seg[s].xq0)) == 0)
+		break;
+	    memcpy(&seg[s].xq[2*i], c2->xq_enc, sizeof(seg[s].xq0));
+	}
+
+	codec2_destroy(c2);
+    }
+
+    return 0;
+}
+
+/* Compares bits[] with a sequential encode of the whole recording */
+
+static void segment_compare(struct CODEC2 *c2, const unsigned char bits[], short speech[],
+			    int nframes, const struct segment seg[], int nsegments,
+			    struct codec2_segment_report *report)
+{
+    int           nsam = codec2_samples_per_frame(c2);
+    int           nbyte = (codec2_bits_per_frame(c2) + 7)/8;
+    unsigned char ref[nbyte];
+    int           f, s, i, d, start;
+
+    report->nsegments = nsegments;
+    report->frames_differ = 0;
+    report->bits_differ = 0;
+    report->max_settle = 0;
+
+    for(f=0, s=0, start=0; f<nframes; f++) {
+	if ((s+1 < nsegments) && (f == start + seg[s].nframes))
+	    start += seg[s++].nframes;
+
+	codec2_encode(c2, ref, &speech[f*nsam]);
+
+	for(i=0, d=0; i<nbyte; i++)
+	    d += __builtin_popcount(ref[i] ^ bits[f*nbyte + i]);
+
+	if (d) {
+	    report->frames_differ++;
+	    report->bits_differ += d;
+	    if (f - start + 1 > report->max_settle)
+		report->max_settle = f - start + 1;
+	}
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+
+  FUNCTION....: codec2_encode_segmented
+  DATE CREATED: Oct 2026
+
+  Encodes nframes frames of speech[] into bits[], nbyte =
+  (codec2_bits_per_frame()+7)/8 bytes per frame as codec2_encode()
+  writes them.  The frames are split into up to nsegments segments of
+  at least CODEC2_SEGMENT_MIN_FRAMES frames, each encoded by its own
+  codec instance on its own thread.  The calling thread encodes the
+  first segment.
+
+  The encoder keeps analysis history, so each segment after the first
+  starts by encoding the nwarmup frames before it and discarding their
+  bits, then the boundaries are stitched by segment_stitch().  The
+  first segment is always identical to a sequential encode, the
+  others are only as close as the warm up makes them.  The 450 mode
+  keeps the longest history (plosive detection on the previous
+  frame's energy), it still differed after 4 frames of warm up on
+  speech and synthetic audio.  CODEC2_SEGMENT_WARMUP leaves a margin
+  over that, but exact bits are not guaranteed; use report to check.
+
+  If report is non-NULL the bits are compared with a sequential encode
+  of the recording, which takes as long as encoding it without
+  segments.
+
+  Returns the number of segments used, or -1 if a codec instance
+  could not be created.
+
+\*---------------------------------------------------------------------------*/
+
+int codec2_encode_segmented(int mode, int gray, unsigned char bits[], short speech[],
+			    int nframes, int nsegments, int nwarmup,
+			    struct codec2_segment_report *report)
+{
+    struct segment *seg;
+    int             nsam, nbyte, start, s, ret;
+
+    assert(nframes >= 0);
+    assert(nwarmup >= 0);
+
+    if (nsegments > nframes/CODEC2_SEGMENT_MIN_FRAMES)
+	nsegments = nframes/CODEC2_SEGMENT_MIN_FRAMES;
+    if (nsegments < 1)
+	nsegments = 1;
+
+    seg = calloc(nsegments, sizeof(struct segment));
+    if (seg == NULL)
+	return -1;
+
+    /* All instances are created before any thread starts */
+
+    ret = nsegments;
+    for(s=0; s<nsegments; s++) {
+	seg[s].c2 = codec2_create(mode);
+	if (seg[s].c2 == NULL) {
+	    ret = -1;
+	    goto done;
+	}
+	codec2_set_natural_or_gray(seg[s].c2, gray);
+    }
+
+    nsam = codec2_samples_per_frame(seg[0].c2);
+    nbyte = (codec2_bits_per_frame(seg[0].c2) + 7)/8;
+
+    for(s=0; s<nsegments; s++) {
+	start = (long)nframes*s/nsegments;
+	seg[s].nwarmup = start < nwarmup ? start : nwarmup;
+	seg[s].nframes = (long)nframes*(s+1)/nsegments - start;
+	seg[s].speech = &speech[(start - seg[s].nwarmup)*nsam];
+	seg[s].bits = &bits[start*nbyte];
+	seg[s].nsam = nsam;
+	seg[s].nbyte = nbyte;
+	seg[s].xq = malloc(2*(seg[s].nframes ? seg[s].nframes : 1)*sizeof(float));
+	if (seg[s].xq == NULL) {
+	    ret = -1;
+	    goto done;
+	}
+    }
+
+    /* If a thread can't be started its segment is encoded by the
+       calling thread after the first */
+
+    for(s=1; s<nsegments; s++)
+	seg[s].started = (pthread_create(&seg[s].thread, NULL, segment_encode, &seg[s]) == 0);
+
+    segment_encode(&seg[0]);
+
+    for(s=1; s<nsegments; s++) {
+	if (seg[s].started)
+	    pthread_join(seg[s].thread, NULL);
+	else
+	    segment_encode(&seg[s]);
+    }
+
+    if (segment_stitch(mode, gray, seg, nsegments) != 0) {
+	ret = -1;
+	goto done;
+    }
+
+    if (report != NULL) {
+	struct CODEC2 *c2 = codec2_create(mode);
+
+	if (c2 == NULL) {
+	    ret = -1;
+	    goto done;
+	}
+	codec2_set_natural_or_gray(c2, gray);
+	segment_compare(c2, bits, speech, nframes, seg, nsegments, report);
+	codec2_destroy(c2);
+    }
+
+ done:
+    for(s=0; s<nsegments; s++) {
+	if (seg[s].c2 != NULL)
+	    codec2_destroy(seg[s].c2);
+	free(seg[s].xq);
+    }
+    free(seg);
+
+    return ret;
+}
@@ -0,0 +1,231 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: generate_vq.c
+  DATE CREATED: Oct 2026
+
+  Writes the codebooks searched by the codec2 modes rearranged for
+  vector search, see struct vq_soa in vq.h.  Run at build time, the
+  output file is compiled into the codec2 library.
+
+  Entries are sorted by their projection on the first principal axis
+  of the codebook, so that each block of VQ_LANES entries covers a
+  narrow range of projections that the search can bound.
+
+  usage: generate_vq output.c
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "defines.h"
+#include "vq.h"
+
+#define PCA_ITERATIONS 200
+
+static const struct {
+    const char                *name;
+    const struct lsp_codebook *books;
+    int                        ndim;  /* elements searched, 0 for all k */
+} codebooks[] = {
+    { "lsp_cb",            lsp_cb,            0 },
+    { "lsp_cbd",           lsp_cbd,           0 },
+    { "ge_cb",             ge_cb,             0 },
+    { "lsp_cbjvm",         lsp_cbjvm,         0 },
+    { "newamp1vq_cb",      newamp1vq_cb,      0 },
+    { "newamp1_energy_cb", newamp1_energy_cb, 0 },
+    { "newamp2vq_cb",      newamp2vq_cb,      29 },  /* NEWAMP2_K, see mbest_search450() */
+    { "newamp2_energy_cb", newamp2_energy_cb, 0 },
+    { NULL, NULL, 0 }
+};
+
+struct entry {
+    double p;                   /* projection on principal axis */
+    int    j;                   /* codebook index               */
+};
+
+static int entry_cmp(const void *a, const void *b)
+{
+    const struct entry *x = a, *y = b;
+
+    if (x->p != y->p)
+        return x->p < y->p ? -1 : 1;
+    return x->j - y->j;
+}
+
+/* Single element codebooks are already in SoA order, and need at least
+   one whole block to be worth storing */
+
+static int needs_soa(const struct lsp_codebook *b)
+{
+    return (b->k > 1) && (b->m >= VQ_LANES);
+}
+
+/* Unit length principal axis u[] of the first ndim elements of the
+   codebook entries, by power iteration on their covariance. */
+
+static void principal_axis(const struct lsp_codebook *b, int ndim, double u[])
+{
+    double mean[ndim], cov[ndim][ndim], v[ndim], norm;
+    int    i, j, n, it;
+
+    for(i=0; i<ndim; i++) {
+        mean[i] = 0.0;
+        for(n=0; n<b->m; n++)
+            mean[i] += b->cb[n*b->k + i];
+        mean[i] /= b->m;
+    }
+
+    for(i=0; i<ndim; i++)
+        for(j=0; j<ndim; j++) {
+            cov[i][j] = 0.0;
+            for(n=0; n<b->m; n++)
+                cov[i][j] += (b->cb[n*b->k + i] - mean[i])*(b->cb[n*b->k + j] - mean[j]);
+        }
+
+    for(i=0; i<ndim; i++)
+        u[i] = 1.0/sqrt(ndim);
+
+    for(it=0; it<PCA_ITERATIONS; it++) {
+        norm = 0.0;
+        for(i=0; i<ndim; i++) {
+            v[i] = 0.0;
+            for(j=0; j<ndim; j++)
+                v[i] += cov[i][j]*u[j];
+            norm += v[i]*v[i];
+        }
+        norm = sqrt(norm);
+        if (norm == 0.0)
+            break;
+        for(i=0; i<ndim; i++)
+            u[i] = v[i]/norm;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *f;
+    int   c, n, b, i, l, count;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s output.c\n", argv[0]);
+        exit(1);
+    }
+
+    f = fopen(argv[1], "wt");
+    if (f == NULL) {
+        perror(argv[1]);
+        exit(1);
+    }
+
+    fprintf(f, "/* THIS IS A GENERATED FILE. Edit generate_vq.c and its input */\n\n");
+    fprintf(f, "/*\n * This intermediary file and the files that used to create it are under\n");
+    fprintf(f, " * The LGPL. See the file COPYING.\n */\n\n");
+    fprintf(f, "#include <stddef.h>\n\n#include \"defines.h\"\n#include \"vq.h\"\n");
+
+    count = 0;
+    for(c=0; codebooks[c].name != NULL; c++) {
+        for(n=0; codebooks[c].books[n].k != 0; n++) {
+            const struct lsp_codebook *p = &codebooks[c].books[n];
+            int    k = p->k;
+            int    ndim = codebooks[c].ndim ? codebooks[c].ndim : k;
+            int    nblocks = (p->m + VQ_LANES - 1)/VQ_LANES;
+            double u[ndim];
+            struct entry *e;
+
+            if (!needs_soa(p))
+                continue;
+
+            principal_axis(p, ndim, u);
+
+            e = malloc(p->m*sizeof(struct entry));
+            for(l=0; l<p->m; l++) {
+                e[l].j = l;
+                e[l].p = 0.0;
+                for(i=0; i<ndim; i++)
+                    e[l].p += u[i]*p->cb[l*k + i];
+            }
+            qsort(e, p->m, sizeof(struct entry), entry_cmp);
+
+            fprintf(f, "\n  /* %s[%d], k=%d m=%d searched over %d elements */\n",
+                    codebooks[c].name, n, k, p->m, ndim);
+
+            fprintf(f, "static const float soa%d[] = {\n", count);
+            for(b=0; b<nblocks; b++)
+                for(i=0; i<k; i++) {
+                    fprintf(f, " ");
+                    for(l=b*VQ_LANES; l<(b+1)*VQ_LANES; l++)
+                        fprintf(f, " %.9g,", l < p->m ? p->cb[e[l].j*k + i] : 0.0);
+                    fprintf(f, "\n");
+                }
+            fprintf(f, "};\n");
+
+            fprintf(f, "static const short index%d[] = {\n", count);
+            for(b=0; b<nblocks; b++) {
+                fprintf(f, " ");
+                for(l=b*VQ_LANES; l<(b+1)*VQ_LANES; l++)
+                    fprintf(f, " %d,", l < p->m ? e[l].j : -1);
+                fprintf(f, "\n");
+            }
+            fprintf(f, "};\n");
+
+            fprintf(f, "static const double u%d[] = {\n", count);
+            for(i=0; i<ndim; i++)
+                fprintf(f, "  %.17g,\n", u[i]);
+            fprintf(f, "};\n");
+
+            fprintf(f, "static const double pmin%d[] = {\n", count);
+            for(b=0; b<nblocks; b++)
+                fprintf(f, "  %.17g,\n", e[b*VQ_LANES].p);
+            fprintf(f, "};\n");
+
+            fprintf(f, "static const double pmax%d[] = {\n", count);
+            for(b=0; b<nblocks; b++) {
+                l = (b+1)*VQ_LANES < p->m ? (b+1)*VQ_LANES : p->m;
+                fprintf(f, "  %.17g,\n", e[l-1].p);
+            }
+            fprintf(f, "};\n");
+
+            free(e);
+            count++;
+        }
+    }
+
+    fprintf(f, "\nconst struct vq_soa vq_soa_codebooks[] = {\n");
+    count = 0;
+    for(c=0; codebooks[c].name != NULL; c++) {
+        for(n=0; codebooks[c].books[n].k != 0; n++) {
+            const struct lsp_codebook *p = &codebooks[c].books[n];
+
+            if (!needs_soa(p))
+                continue;
+
+            fprintf(f, "  { &%s[%d], %d, %d, soa%d, index%d, u%d, pmin%d, pmax%d },\n",
+                    codebooks[c].name, n, codebooks[c].ndim ? codebooks[c].ndim : p->k,
+                    (p->m + VQ_LANES - 1)/VQ_LANES, count, count, count, count, count);
+            count++;
+        }
+    }
+    fprintf(f, "  { NULL, 0, 0, NULL, NULL, NULL, NULL, NULL }\n};\n");
+
+    fclose(f);
+
+    return 0;
+}
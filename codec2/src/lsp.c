@@ -30,10 +30,13 @@
 
 #include "defines.h"
 #include "lsp.h"
+#include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#define LSP_MAX_NB 16		/* most sub-intervals lpc_to_lsp() bisects	*/
+
 /*---------------------------------------------------------------------------*\
 
   Introduction to Line Spectrum Pairs (LSPs)
@@ -77,10 +80,10 @@
   AUTHOR......: David Rowe
   DATE CREATED: 24/2/93
 
-  This function evalutes a series of chebyshev polynomials
-
-  FIXME: performing memory allocation at run time is very inefficient,
-  replace with stack variables of MAX_P size.
+  This function evalutes a series of chebyshev polynomials.  Each
+  polynomial is added to the sum as it is generated, in the same
+  order as when they were first stored in an array, so the result is
+  unchanged.
 
 \*---------------------------------------------------------------------------*/
 
@@ -92,29 +95,22 @@ cheb_poly_eva(float *coef,float x,int order)
 /*  int order 		order of the polynomial 			*/
 {
     int i;
-    float *t,*u,*v,sum;
-    float T[(order / 2) + 1];
-
-    /* Initialise pointers */
+    float tp,tc,t,sum;
 
-    t = T;                          	/* T[i-2] 			*/
-    *t++ = 1.0;
-    u = t--;                        	/* T[i-1] 			*/
-    *u++ = x;
-    v = u--;                        	/* T[i] 			*/
+    tp = 1.0;                          	/* T[i-2] 			*/
+    tc = x;                         	/* T[i-1] 			*/
 
     /* Evaluate chebyshev series formulation using iterative approach 	*/
 
-    for(i=2;i<=order/2;i++)
-	*v++ = (2*x)*(*u++) - *t++;  	/* T[i] = 2*x*T[i-1] - T[i-2]	*/
-
     sum=0.0;                        	/* initialise sum to zero 	*/
-    t = T;                          	/* reset pointer 		*/
-
-    /* Evaluate polynomial and return value also free memory space */
-
-    for(i=0;i<=order/2;i++)
-	sum+=coef[(order/2)-i]**t++;
+    sum+=coef[(order/2)]*tp;
+    sum+=coef[(order/2)-1]*tc;
+    for(i=2;i<=order/2;i++){
+	t = (2*x)*tc - tp;  		/* T[i] = 2*x*T[i-1] - T[i-2]	*/
+	sum+=coef[(order/2)-i]*t;
+	tp = tc;
+	tc = t;
+    }
 
     return sum;
 }
@@ -139,7 +135,9 @@ int lpc_to_lsp (float *a, int order, float *freq, int nb, float delta)
 {
     float psuml,psumr,psumm,temp_xr,xl,xr,xm = 0;
     float temp_psumr;
-    int i,j,m,flag,k;
+    float xa,xb,xc;		/* predicted bisection interval, root	*/
+    float xs[LSP_MAX_NB], ps[LSP_MAX_NB]; /* predicted bisection points, values */
+    int i,j,m,flag,k,left;
     float *px;                	/* ptrs of respective P'(z) & Q'(z)	*/
     float *qx;
     float *p;
@@ -150,6 +148,8 @@ int lpc_to_lsp (float *a, int order, float *freq, int nb, float delta)
     float Q[order + 1];
     float P[order + 1];
 
+    assert(nb < LSP_MAX_NB);
+
     flag = 1;
     m = order/2;            	/* order of P'(z) & Q'(z) polynimials 	*/
 
@@ -212,18 +212,46 @@ int lpc_to_lsp (float *a, int order, float *freq, int nb, float delta)
 	    if(((psumr*psuml)<0.0) || (psumr == 0.0)){
 		roots++;
 
-		psumm=psuml;
-		for(k=0;k<=nb;k++){
-		    xm = (xl+xr)/2;        	/* bisect the interval 	*/
-		    psumm=cheb_poly_eva(pt,xm,order);
-		    if(psumm*psuml>0.){
-			psuml=psumm;
-			xl=xm;
-		    }
-		    else{
-			psumr=psumm;
-			xr=xm;
+		/* Each bisection would wait on the polynomial value
+		   before it, so instead the path is predicted from
+		   where the chord between xl and xr crosses zero, the
+		   values along it are evaluated together, and the steps
+		   made with them until one goes the other way.  Then the
+		   rest of the path is predicted again from the new
+		   interval.  The steps made are exactly the bisection's. */
+
+		k = 0;
+		while(k <= nb){
+		    if (psuml != psumr)
+			xc = xl - psuml*(xl - xr)/(psuml - psumr);
+		    else
+			xc = (xl+xr)/2;
+		    xa = xl;
+		    xb = xr;
+		    for(i=k;i<=nb;i++){
+			xs[i] = (xa+xb)/2;
+			if (xs[i] > xc)
+			    xa = xs[i];
+			else
+			    xb = xs[i];
 		    }
+		    for(i=k;i<=nb;i++)
+			ps[i] = cheb_poly_eva(pt,xs[i],order);
+
+		    do {
+			xm = xs[k];        	/* bisect the interval 	*/
+			psumm = ps[k];
+			left = psumm*psuml>0.;
+			if(left){
+			    psuml=psumm;
+			    xl=xm;
+			}
+			else{
+			    psumr=psumm;
+			    xr=xm;
+			}
+			k++;
+		    } while(k <= nb && left == (xm > xc));
 		}
 
 	       /* once zero is found, reset initial interval to xr 	*/
@@ -34,9 +34,9 @@
 #include <string.h>
 
 #include "mbest.h"
+#include "vq.h"
 
 struct MBEST *mbest_create(int entries) {
-    int           i,j;
     struct MBEST *mbest;
 
     assert(entries > 0);
@@ -46,20 +46,33 @@ struct MBEST *mbest_create(int entries) {
     mbest->entries = entries;
     mbest->list = (struct MBEST_LIST *)malloc(entries*sizeof(struct MBEST_LIST));
     assert(mbest->list != NULL);
+    mbest->best_e = (float *)malloc(entries*sizeof(float));
+    mbest->best_j = (int *)malloc(entries*sizeof(int));
+    assert((mbest->best_e != NULL) && (mbest->best_j != NULL));
+
+    mbest_reset(mbest);
+
+    return mbest;
+}
+
+/* Empties the list, so one MBEST can be used for every frame */
+
+void mbest_reset(struct MBEST *mbest) {
+    int i,j;
 
     for(i=0; i<mbest->entries; i++) {
 	for(j=0; j<MBEST_STAGES; j++)
 	    mbest->list[i].index[j] = 0;
 	mbest->list[i].error = 1E32;
     }
-
-    return mbest;
 }
 
 
 void mbest_destroy(struct MBEST *mbest) {
     assert(mbest != NULL);
     free(mbest->list);
+    free(mbest->best_e);
+    free(mbest->best_j);
     free(mbest);
 }
 
@@ -75,20 +88,23 @@ void mbest_destroy(struct MBEST *mbest) {
 \*---------------------------------------------------------------------------*/
 
 void mbest_insert(struct MBEST *mbest, int index[], float error) {
-    int                i, j, found;
+    int                i, j, pos;
     struct MBEST_LIST *list    = mbest->list;
     int                entries = mbest->entries;
 
-    found = 0;
-    for(i=0; i<entries && !found; i++)
-	if (error < list[i].error) {
-	    found = 1;
-	    for(j=entries-1; j>i; j--)
-		list[j] = list[j-1];
-	    for(j=0; j<MBEST_STAGES; j++)
-		list[i].index[j] = index[j];
-	    list[i].error = error;
-	}
+    /* the list is sorted, so the new entry goes after every entry with
+       an error no larger than its own, counted without branching */
+
+    pos = 0;
+    for(i=0; i<entries; i++)
+	pos += !(error < list[i].error);
+    if (pos == entries)
+	return;
+
+    memmove(&list[pos+1], &list[pos], (entries-pos-1)*sizeof(struct MBEST_LIST));
+    for(j=0; j<MBEST_STAGES; j++)
+	list[pos].index[j] = index[j];
+    list[pos].error = error;
 }
 
 
@@ -104,6 +120,32 @@ void mbest_print(char title[], struct MBEST *mbest) {
 }
 
 
+/* Searches the first ndim elements of the codebook for entries that
+   beat the last one on the mbest list, then inserts them in order of
+   error and index, giving the same list as inserting every entry in
+   turn. */
+
+static void mbest_search_vq(const float *cb, float vec[], float w[], int k, int ndim, int m,
+                            struct MBEST *mbest, int index[])
+{
+   float  *best_e = mbest->best_e;
+   int    *best_j = mbest->best_j;
+   int     i;
+
+   for(i=0; i<mbest->entries; i++) {
+	best_e[i] = mbest->list[mbest->entries-1].error;
+	best_j[i] = -1;
+   }
+
+   vq_search(cb, k, ndim, m, vec, w, VQ_WEIGHT_SQ, mbest->entries, best_e, best_j);
+
+   for(i=0; i<mbest->entries && best_j[i] >= 0; i++) {
+	index[0] = best_j[i];
+	mbest_insert(mbest, index, best_e[i]);
+   }
+}
+
+
 /*---------------------------------------------------------------------------*\
 
   mbest_search
@@ -123,19 +165,7 @@ void mbest_search(
 		  int           index[] /* indexes that lead us here     */
 )
 {
-   float   e;
-   int     i,j;
-   float   diff;
-
-   for(j=0; j<m; j++) {
-	e = 0.0;
-	for(i=0; i<k; i++) {
-	    diff = cb[j*k+i]-vec[i];
-	    e += diff*w[i]*diff*w[i];
-	}
-	index[0] = j;
-	mbest_insert(mbest, index, e);
-   }
+   mbest_search_vq(cb, vec, w, k, k, m, mbest, index);
 }
 
 
@@ -151,21 +181,6 @@ void mbest_search(
 void mbest_search450(const float  *cb, float vec[], float w[], int k,int shorterK, int m, struct MBEST *mbest, int index[])
 
 {
-    float   e;
-    int     i,j;
-    float   diff;
-
-    for(j=0; j<m; j++) {
-	e = 0.0;
-	for(i=0; i<k; i++) {
-            //Only search first NEWAMP2_K Vectors
-            if(i<shorterK){
-                diff = cb[j*k+i]-vec[i];
-                e += diff*w[i] * diff*w[i];
-            }
-	}
-	index[0] = j;
-	mbest_insert(mbest, index, e);
-    }
+    //Only search first NEWAMP2_K Vectors
+    mbest_search_vq(cb, vec, w, k, shorterK < k ? shorterK : k, m, mbest, index);
 }
-   
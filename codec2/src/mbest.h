@@ -40,10 +40,13 @@ struct MBEST_LIST {
 struct MBEST {
     int                entries;   /* number of entries in mbest list   */
     struct MBEST_LIST *list;
+    float             *best_e;    /* [entries] search scratch          */
+    int               *best_j;
 };
 
 struct MBEST *mbest_create(int entries);
 void mbest_destroy(struct MBEST *mbest);
+void mbest_reset(struct MBEST *mbest);
 void mbest_insert(struct MBEST *mbest, int index[], float error);
 void mbest_search(const float  *cb, float vec[], float w[], int k, int m, struct MBEST *mbest, int index[]);
 void mbest_search450(const float  *cb, float vec[], float w[], int k,int shorterK, int m, struct MBEST *mbest, int index[]);
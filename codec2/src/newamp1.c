@@ -155,16 +155,19 @@ void resample_const_rate_f(C2CONST *c2const, MODEL *model, float rate_K_vec[], f
   AUTHOR......: David Rowe
   DATE CREATED: Jan 2017
 
-  Two stage rate K newamp1 VQ quantiser using mbest search.
+  Two stage rate K newamp1 VQ quantiser using mbest search.  The
+  mbest lists are supplied by the caller and reused every frame, the
+  number of stage 1 candidates searched at stage 2 is the size of
+  mbest_stage1.
 
 \*---------------------------------------------------------------------------*/
 
-float rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim, int mbest_entries)
+float rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim,
+                          struct MBEST *mbest_stage1, struct MBEST *mbest_stage2)
 {
   int i, j, n1, n2;
   const float *codebook1 = newamp1vq_cb[0].cb;
   const float *codebook2 = newamp1vq_cb[1].cb;
-  struct MBEST *mbest_stage1, *mbest_stage2;
   float target[ndim];
   float w[ndim];
   int   index[MBEST_STAGES];
@@ -179,8 +182,8 @@ float rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim, int mbest
   for(i=0; i<ndim; i++)
       w[i] = 1.0;
 
-  mbest_stage1 = mbest_create(mbest_entries);
-  mbest_stage2 = mbest_create(mbest_entries);
+  mbest_reset(mbest_stage1);
+  mbest_reset(mbest_stage2);
   for(i=0; i<MBEST_STAGES; i++)
       index[i] = 0;
 
@@ -190,7 +193,7 @@ float rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim, int mbest
 
   /* Stage 2 */
 
-  for (j=0; j<mbest_entries; j++) {
+  for (j=0; j<mbest_stage1->entries; j++) {
       index[1] = n1 = mbest_stage1->list[j].index[0];
       for(i=0; i<ndim; i++)
 	  target[i] = x[i] - codebook1[ndim*n1+i];
@@ -206,9 +209,6 @@ float rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim, int mbest
       xq[i] = tmp;
   }
 
-  mbest_destroy(mbest_stage1);
-  mbest_destroy(mbest_stage2);
-
   indexes[0] = n1; indexes[1] = n2;
 
   return mse;
@@ -359,15 +359,18 @@ void resample_rate_L(C2CONST *c2const, MODEL *model, float rate_K_vec[], float r
   DATE CREATED: Jan 2017
 
   Given a magnitude spectrum determine a phase spectrum, used for
-  phase synthesis with newamp1.
+  phase synthesis with newamp1.  scratch[] is DETERMINE_PHASE_SCRATCH(Nfft)
+  floats of work space.
 
 \*---------------------------------------------------------------------------*/
 
-void determine_phase(C2CONST *c2const, COMP H[], MODEL *model, int Nfft, codec2_fft_cfg fwd_cfg, codec2_fft_cfg inv_cfg)
+void determine_phase(C2CONST *c2const, COMP H[], MODEL *model, int Nfft, codec2_fft_cfg fwd_cfg, codec2_fft_cfg inv_cfg, float scratch[])
 {
     int i,m,b;
     int Ns = Nfft/2+1;
-    float Gdbfk[Ns], sample_freqs_kHz[Ns], phase[Ns];
+    COMP  *work = (COMP*)scratch;
+    float *Gdbfk = &scratch[2*MAG_TO_PHASE_SCRATCH(Nfft)];
+    float *sample_freqs_kHz = &Gdbfk[Ns], *phase = &Gdbfk[2*Ns];
     float AmdB[MAX_AMP+1], rate_L_sample_freqs_kHz[MAX_AMP+1];
 
     for(m=1; m<=model->L; m++) {
@@ -381,7 +384,7 @@ void determine_phase(C2CONST *c2const, COMP H[], MODEL *model, int Nfft, codec2_
     }
 
     interp_para(Gdbfk, &rate_L_sample_freqs_kHz[1], &AmdB[1], model->L, sample_freqs_kHz, Ns);
-    mag_to_phase(phase, Gdbfk, Nfft, fwd_cfg, inv_cfg);
+    mag_to_phase(phase, Gdbfk, Nfft, fwd_cfg, inv_cfg, work);
 
     for(m=1; m<=model->L; m++) {
         b = floorf(0.5+m*model->Wo*Nfft/(2.0*M_PI));
@@ -396,15 +399,17 @@ void determine_phase(C2CONST *c2const, COMP H[], MODEL *model, int Nfft, codec2_
   DATE CREATED: April 2020
 
   Determine autocorrelation coefficients from model params, for machine 
-  learning experiments.
+  learning experiments.  scratch[] is DETERMINE_AUTOC_SCRATCH(Nfft)
+  floats of work space.
 
 \*---------------------------------------------------------------------------*/
 
-void determine_autoc(C2CONST *c2const, float Rk[], int order, MODEL *model, int Nfft, codec2_fft_cfg fwd_cfg, codec2_fft_cfg inv_cfg)
+void determine_autoc(C2CONST *c2const, float Rk[], int order, MODEL *model, int Nfft, codec2_fft_cfg fwd_cfg, codec2_fft_cfg inv_cfg, float scratch[])
 {
     int i,m;
     int Ns = Nfft/2+1;
-    float Gdbfk[Ns], sample_freqs_kHz[Ns];
+    COMP  *S = (COMP*)scratch, *R = &S[Nfft];
+    float *Gdbfk = &scratch[2*2*Nfft], *sample_freqs_kHz = &Gdbfk[Ns];
     float AmdB[MAX_AMP+1], rate_L_sample_freqs_kHz[MAX_AMP+1];
 
     /* interpolate in the log domain */
@@ -420,8 +425,6 @@ void determine_autoc(C2CONST *c2const, float Rk[], int order, MODEL *model, int
 
     interp_para(Gdbfk, &rate_L_sample_freqs_kHz[1], &AmdB[1], model->L, sample_freqs_kHz, Ns);
 
-    COMP S[Nfft], R[Nfft];
-
     /* install negative frequency components, convert to mag squared of spectrum */
     S[0].real = pow(10.0, Gdbfk[0]/10.0);
     S[0].imag = 0.0;
@@ -473,7 +476,9 @@ void newamp1_model_to_indexes(C2CONST *c2const,
                               float  rate_K_vec_no_mean_[],
                               float *se,
                               float *eq,
-                              int    eq_en
+                              int    eq_en,
+                              struct MBEST *mbest_stage1,
+                              struct MBEST *mbest_stage2
                               )
 {
     int k;
@@ -493,7 +498,7 @@ void newamp1_model_to_indexes(C2CONST *c2const,
     newamp1_eq(rate_K_vec_no_mean, eq, K, eq_en);
  
     /* two stage VQ */
-    rate_K_mbest_encode(indexes, rate_K_vec_no_mean, rate_K_vec_no_mean_, K, NEWAMP1_VQ_MBEST_DEPTH);
+    rate_K_mbest_encode(indexes, rate_K_vec_no_mean, rate_K_vec_no_mean_, K, mbest_stage1, mbest_stage2);
 
     /* running sum of squared error for variance calculation */
     for(k=0; k<K; k++)
@@ -619,7 +624,8 @@ void newamp1_indexes_to_model(C2CONST *c2const,
                               codec2_fft_cfg inv_cfg,
                               int    indexes[],
                               float  user_rate_K_vec_no_mean_[],
-                              int    post_filter_en)
+                              int    post_filter_en,
+                              float  scratch[])
 {
     float rate_K_vec_[K], rate_K_vec_no_mean_[K], mean_, Wo_right;
     int   voicing_right, k;
@@ -668,7 +674,7 @@ void newamp1_indexes_to_model(C2CONST *c2const,
         model_[i].voiced = avoicing_[i];
 
         resample_rate_L(c2const, &model_[i], &interpolated_surface_[K*i], rate_K_sample_freqs_kHz, K);
-        determine_phase(c2const, &H[(MAX_AMP+1)*i], &model_[i], NEWAMP1_PHASE_NFFT, fwd_cfg, inv_cfg);
+        determine_phase(c2const, &H[(MAX_AMP+1)*i], &model_[i], NEWAMP1_PHASE_NFFT, fwd_cfg, inv_cfg, scratch);
     }
 
     /* update memories for next time */
@@ -37,20 +37,27 @@
 #define NEWAMP1_K           20   /* rate K vector length                            */
 #define NEWAMP1_VQ_MBEST_DEPTH 5 /* how many candidates we keep for each stage of mbest search */
 
+/* floats of work space needed by determine_phase() and determine_autoc() */
+
+#define DETERMINE_PHASE_SCRATCH(Nfft) (2*4*(Nfft) + 3*((Nfft)/2+1))
+#define DETERMINE_AUTOC_SCRATCH(Nfft) (2*2*(Nfft) + 2*((Nfft)/2+1))
+
 
 #include "codec2_fft.h"
 #include "comp.h"
+#include "mbest.h"
 
 void interp_para(float y[], float xp[], float yp[], int np, float x[], int n);
 float ftomel(float fHz);
 void mel_sample_freqs_kHz(float rate_K_sample_freqs_kHz[], int K, float mel_start, float mel_end);
 void resample_const_rate_f(C2CONST *c2const, MODEL *model, float rate_K_vec[], float rate_K_sample_freqs_kHz[], int K);
-float rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim, int mbest_entries);
+float rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim,
+                          struct MBEST *mbest_stage1, struct MBEST *mbest_stage2);
 void post_filter_newamp1(float vec[], float sample_freq_kHz[], int K, float pf_gain);
 void interp_Wo_v(float Wo_[], int L_[], int voicing_[], float Wo1, float Wo2, int voicing1, int voicing2);
 void resample_rate_L(C2CONST *c2const, MODEL *model, float rate_K_vec[], float rate_K_sample_freqs_kHz[], int K);
-void determine_phase(C2CONST *c2const, COMP H[], MODEL *model, int Nfft, codec2_fft_cfg fwd_cfg, codec2_fft_cfg inv_cfg);
-void determine_autoc(C2CONST *c2const, float Rk[], int order, MODEL *model, int Nfft, codec2_fft_cfg fwd_cfg, codec2_fft_cfg inv_cfg);
+void determine_phase(C2CONST *c2const, COMP H[], MODEL *model, int Nfft, codec2_fft_cfg fwd_cfg, codec2_fft_cfg inv_cfg, float scratch[]);
+void determine_autoc(C2CONST *c2const, float Rk[], int order, MODEL *model, int Nfft, codec2_fft_cfg fwd_cfg, codec2_fft_cfg inv_cfg, float scratch[]);
 void newamp1_model_to_indexes(C2CONST *c2const,
                               int    indexes[], 
                               MODEL *model, 
@@ -62,7 +69,9 @@ void newamp1_model_to_indexes(C2CONST *c2const,
                               float  rate_K_vec_no_mean_[],
                               float *se,
                               float *eq,
-                              int    eq_en);
+                              int    eq_en,
+                              struct MBEST *mbest_stage1,
+                              struct MBEST *mbest_stage2);
 void newamp1_indexes_to_rate_K_vec(float  rate_K_vec_[],  
                                    float  rate_K_vec_no_mean_[],
                                    float  rate_K_sample_freqs_kHz[], 
@@ -86,6 +95,7 @@ void newamp1_indexes_to_model(C2CONST *c2const,
                               codec2_fft_cfg inv_cfg,
                               int    indexes[],
                               float user_rate_K_vec_no_mean_[],
-                              int post_filter_en);
+                              int post_filter_en,
+                              float scratch[]);
 
 #endif
@@ -117,15 +117,15 @@ void n2_resample_const_rate_f(C2CONST *c2const, MODEL *model, float rate_K_vec[]
   INSTITUTE...:	Institute for Electronics Engineering, University of Erlangen-Nuremberg
   DATE CREATED: July 2018
 
-  One stage rate K newamp2 VQ quantiser using mbest search.
+  One stage rate K newamp2 VQ quantiser using mbest search.  The mbest
+  list is supplied by the caller and reused every frame.
 
 \*---------------------------------------------------------------------------*/
 
-void n2_rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim)
+void n2_rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim, struct MBEST *mbest_stage1)
 {
   int i, n1;
   const float *codebook1 = newamp2vq_cb[0].cb;
-  struct MBEST *mbest_stage1;
   float w[ndim];
   int   index[1];
 
@@ -138,7 +138,7 @@ void n2_rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim)
   for(i=0; i<ndim; i++)
       w[i] = 1.0;
 
-  mbest_stage1 = mbest_create(1);
+  mbest_reset(mbest_stage1);
   
   index[0] = 0;
 
@@ -147,8 +147,6 @@ void n2_rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim)
   mbest_search450(codebook1, x, w, ndim,NEWAMP2_K, newamp2vq_cb[0].m, mbest_stage1, index);
   n1 = mbest_stage1->list[0].index[0];
 
-  mbest_destroy(mbest_stage1);
-
   //indexes[1]: legacy from newamp1
   indexes[0] = n1; indexes[1] = n1;
 
@@ -264,7 +262,8 @@ void newamp2_model_to_indexes(C2CONST *c2const,
                               float *mean,
                               float  rate_K_vec_no_mean[], 
                               float  rate_K_vec_no_mean_[],
-							  int    plosive
+							  int    plosive,
+                              struct MBEST *mbest_stage1
                               )
 {
     int k;
@@ -285,7 +284,7 @@ void newamp2_model_to_indexes(C2CONST *c2const,
 	}
 	//NEWAMP2_16K_K+1 because the last vector is not a vector for VQ (and not included in the constant)
 	//but a calculated medium mean value
-    n2_rate_K_mbest_encode(indexes, rate_K_vec_no_mean, rate_K_vec_no_mean_, NEWAMP2_16K_K+1);
+    n2_rate_K_mbest_encode(indexes, rate_K_vec_no_mean, rate_K_vec_no_mean_, NEWAMP2_16K_K+1, mbest_stage1);
 
     /* scalar quantise mean (effectively the frame energy) */
 
@@ -474,7 +473,8 @@ void newamp2_indexes_to_model(C2CONST *c2const,
                               codec2_fft_cfg inv_cfg,
                               int    indexes[],
                               float pf_gain,
-                              int flag16k)
+                              int flag16k,
+                              float scratch[])
 {
     float rate_K_vec_[K], rate_K_vec_no_mean_[K], mean_, Wo_right;
     int   voicing_right, k;
@@ -554,7 +554,7 @@ void newamp2_indexes_to_model(C2CONST *c2const,
 		else{
 			n2_resample_rate_L(c2const, &model_[i], &interpolated_surface_[K*i], rate_K_sample_freqs_kHz, K,0);
 		}
-		determine_phase(c2const, &H[(MAX_AMP+1)*i], &model_[i], NEWAMP2_PHASE_NFFT, fwd_cfg, inv_cfg);
+		determine_phase(c2const, &H[(MAX_AMP+1)*i], &model_[i], NEWAMP2_PHASE_NFFT, fwd_cfg, inv_cfg, scratch);
     }
 
     /* update memories for next time */
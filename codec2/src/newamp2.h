@@ -41,10 +41,11 @@
 
 #include "codec2_fft.h"
 #include "comp.h"
+#include "mbest.h"
 
 void n2_mel_sample_freqs_kHz(float rate_K_sample_freqs_kHz[], int K);
 void n2_resample_const_rate_f(C2CONST *c2const, MODEL *model, float rate_K_vec[], float rate_K_sample_freqs_kHz[], int K);
-void n2_rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim);
+void n2_rate_K_mbest_encode(int *indexes, float *x, float *xq, int ndim, struct MBEST *mbest_stage1);
 void n2_resample_rate_L(C2CONST *c2const, MODEL *model, float rate_K_vec[], float rate_K_sample_freqs_kHz[], int K,int plosive_flag);
 void n2_post_filter_newamp2(float vec[], float sample_freq_kHz[], int K, float pf_gain);
 void newamp2_interpolate(float interpolated_surface_[], float left_vec[], float right_vec[], int K,int plosive_flag);
@@ -57,7 +58,8 @@ void newamp2_model_to_indexes(C2CONST *c2const,
                               float *mean,
                               float  rate_K_vec_no_mean[], 
                               float  rate_K_vec_no_mean_[],
-                              int	 plosiv
+                              int	 plosiv,
+                              struct MBEST *mbest_stage1
                               );
 void newamp2_indexes_to_rate_K_vec(float  rate_K_vec_[],  
                                    float  rate_K_vec_no_mean_[],
@@ -86,6 +88,7 @@ void newamp2_indexes_to_model(C2CONST *c2const,
                               codec2_fft_cfg inv_cfg,
                               int    indexes[],
                               float  pf_gain,
-                              int flag16k);
+                              int flag16k,
+                              float  scratch[]);
 
 #endif
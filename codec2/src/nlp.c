@@ -123,10 +123,11 @@ typedef struct {
     int           Fs;                /* sample rate in Hz            */
     int           m;
     float         w[PMAX_M/DEC];     /* DFT window                   */
-    float         sq[PMAX_M];	     /* squared speech samples       */
+    float         sq[PMAX_M/DEC];    /* filtered and decimated squared speech samples */
     float         mem_x,mem_y;       /* memory for notch filter      */
-    float         mem_fir[NLP_NTAP]; /* decimation FIR filter memory */
-    codec2_fft_cfg  fft_cfg;         /* kiss FFT config              */
+    float         mem_fir[NLP_NTAP-1+PMAX_M]; /* decimation FIR filter memory followed by
+                                                 squared speech samples of current frame */
+    codec2_fftr_cfg fftr_cfg;        /* kiss real FFT config         */
     float        *Sn16k;	     /* Fs=16kHz input speech vector */
     FILE         *f;
 } NLP;
@@ -178,20 +179,26 @@ void *nlp_create(C2CONST *c2const)
     }
 
     assert(m <= PMAX_M);
+
+    /* decimating filter only evaluates every DEC-th output, so frame
+       boundaries must line up with the decimated sample grid */
+
+    assert((m % DEC) == 0);
+    assert(((c2const->n_samp*8000/Fs) % DEC) == 0);
     
     for(i=0; i<m/DEC; i++) {
 	nlp->w[i] = 0.5 - 0.5*cosf(2*PI*i/(m/DEC-1));
     }
 
-    for(i=0; i<PMAX_M; i++)
+    for(i=0; i<PMAX_M/DEC; i++)
 	nlp->sq[i] = 0.0;
     nlp->mem_x = 0.0;
     nlp->mem_y = 0.0;
-    for(i=0; i<NLP_NTAP; i++)
+    for(i=0; i<NLP_NTAP-1+PMAX_M; i++)
 	nlp->mem_fir[i] = 0.0;
 
-    nlp->fft_cfg = codec2_fft_alloc (PE_FFT_SIZE, 0, NULL, NULL);
-    assert(nlp->fft_cfg != NULL);
+    nlp->fftr_cfg = codec2_fftr_alloc (PE_FFT_SIZE, 0, NULL, NULL);
+    assert(nlp->fftr_cfg != NULL);
 
     return (void*)nlp;
 }
@@ -210,7 +217,7 @@ void nlp_destroy(void *nlp_state)
     assert(nlp_state != NULL);
     nlp = (NLP*)nlp_state;
 
-    codec2_fft_free(nlp->fft_cfg);
+    codec2_fftr_free(nlp->fftr_cfg);
     if (nlp->Fs == 16000) {
         free(nlp->Sn16k);
     }
@@ -259,7 +266,10 @@ float nlp(
 {
     NLP   *nlp;
     float  notch;		    /* current notch filter output          */
-    COMP   Fw[PE_FFT_SIZE];	    /* DFT of squared signal (input/output) */
+    float  fw[PE_FFT_SIZE];	    /* windowed decimated squared signal    */
+    COMP   Fw[PE_FFT_SIZE/2+1];    /* DFT of squared signal                */
+    float *x;			    /* squared samples of current frame     */
+    float  acc;
     float  gmax;
     int    gmax_bin;
     int    m, i, j;
@@ -269,6 +279,7 @@ float nlp(
     assert(nlp_state != NULL);
     nlp = (NLP*)nlp_state;
     m = nlp->m;
+    x = &nlp->mem_fir[NLP_NTAP-1];
 
     /* Square, notch filter at DC, and LP filter vector */
 
@@ -279,8 +290,8 @@ float nlp(
     if (nlp->Fs == 8000) {
         /* Square latest input samples */
 
-        for(i=m-n; i<m; i++) {
-	  nlp->sq[i] = Sn[i]*Sn[i];
+        for(i=m-n, j=0; i<m; i++, j++) {
+	  x[j] = Sn[i]*Sn[i];
         }
     }
     else {
@@ -294,13 +305,14 @@ float nlp(
 
         m /= 2; n /= 2;
 
-        float Sn8k[n];
-        fdmdv_16_to_8(Sn8k, &nlp->Sn16k[FDMDV_OS_TAPS_16K], n);
+        /* decimate straight into x[] and square in place */
+
+        fdmdv_16_to_8(x, &nlp->Sn16k[FDMDV_OS_TAPS_16K], n);
 
         /* Square latest input samples */
 
         for(i=m-n, j=0; i<m; i++, j++) {
-	    nlp->sq[i] = Sn8k[j]*Sn8k[j];
+	    x[j] = x[j]*x[j];
         }
         assert(j <= n);
     }
@@ -308,12 +320,12 @@ float nlp(
 
     PROFILE_SAMPLE(start);
 
-    for(i=m-n; i<m; i++) {	/* notch filter at DC */
-	notch = nlp->sq[i] - nlp->mem_x;
+    for(i=0; i<n; i++) {	/* notch filter at DC */
+	notch = x[i] - nlp->mem_x;
 	notch += COEFF*nlp->mem_y;
-	nlp->mem_x = nlp->sq[i];
+	nlp->mem_x = x[i];
 	nlp->mem_y = notch;
-	nlp->sq[i] = notch + 1.0;  /* With 0 input vectors to codec,
+	x[i] = notch + 1.0;  /* With 0 input vectors to codec,
 				      kiss_fft() would take a long
 				      time to execute when running in
 				      real time.  Problem was traced
@@ -325,44 +337,53 @@ float nlp(
 
     PROFILE_SAMPLE_AND_LOG(tnotch, start, "      square and notch");
 
-    for(i=m-n; i<m; i++) {	/* FIR filter vector */
+    /* Shift decimated samples in buffer to make room for new samples */
 
-	for(j=0; j<NLP_NTAP-1; j++)
-	    nlp->mem_fir[j] = nlp->mem_fir[j+1];
-	nlp->mem_fir[NLP_NTAP-1] = nlp->sq[i];
+    for(i=0; i<(m-n)/DEC; i++)
+	nlp->sq[i] = nlp->sq[i+n/DEC];
 
-	nlp->sq[i] = 0.0;
-	for(j=0; j<NLP_NTAP; j++)
-	    nlp->sq[i] += nlp->mem_fir[j]*nlp_fir[j];
+    /* FIR filter and decimate.  Only every DEC-th filter output is
+       used, so the others are never computed.  x[i] is the newest
+       sample under the filter, x[i-NLP_NTAP+1] the oldest. */
+
+    for(i=0, j=(m-n)/DEC; i<n; i+=DEC, j++) {
+	const float *h = &x[i-(NLP_NTAP-1)];
+	int k;
+
+	acc = 0.0;
+	for(k=0; k<NLP_NTAP; k++)
+	    acc += h[k]*nlp_fir[k];
+	nlp->sq[j] = acc;
     }
 
+    /* update filter memory */
+
+    for(i=-(NLP_NTAP-1); i<0; i++)
+	x[i] = x[i+n];
+
     PROFILE_SAMPLE_AND_LOG(filter, tnotch, "      filter");
 
-    /* Decimate and DFT */
+    /* Window and DFT.  Input is real so a real FFT gives the
+       PE_FFT_SIZE/2+1 non-negative frequency bins we search. */
 
-    for(i=0; i<PE_FFT_SIZE; i++) {
-	Fw[i].real = 0.0;
-	Fw[i].imag = 0.0;
-    }
     for(i=0; i<m/DEC; i++) {
-	Fw[i].real = nlp->sq[i*DEC]*nlp->w[i];
+	fw[i] = nlp->sq[i]*nlp->w[i];
+    }
+    for(; i<PE_FFT_SIZE; i++) {
+	fw[i] = 0.0;
     }
     PROFILE_SAMPLE_AND_LOG(window, filter, "      window");
-    #ifdef DUMP
-    dump_dec(Fw);
-    #endif
 
-    // FIXME: check if this can be converted to a real fft
-    // since all imag inputs are 0
-    codec2_fft_inplace(nlp->fft_cfg, Fw);
+    codec2_fftr(nlp->fftr_cfg, fw, Fw);
     PROFILE_SAMPLE_AND_LOG(fft, window, "      fft");
 
-    for(i=0; i<PE_FFT_SIZE; i++)
+    for(i=0; i<PE_FFT_SIZE/2+1; i++) {
 	Fw[i].real = Fw[i].real*Fw[i].real + Fw[i].imag*Fw[i].imag;
+    }
 
     PROFILE_SAMPLE_AND_LOG(magsq, fft, "      mag sq");
     #ifdef DUMP
-    dump_sq(m, nlp->sq);
+    dump_sq(m/DEC, nlp->sq);
     dump_Fw(Fw);
     #endif
 
@@ -388,11 +409,6 @@ float nlp(
 
     PROFILE_SAMPLE_AND_LOG(shiftmem, peakpick,  "      post process");
 
-    /* Shift samples in buffer to make room for new samples */
-
-    for(i=0; i<m-n; i++)
-	nlp->sq[i] = nlp->sq[i+n];
-
     /* return pitch period in samples and F0 estimate */
 
     *pitch = (float)nlp->Fs/best_f0;
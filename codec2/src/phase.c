@@ -234,10 +234,11 @@ void mag_to_phase(float phase[],             /* Nfft/2+1 output phase samples in
                   float Gdbfk[],             /* Nfft/2+1 postive freq amplitudes samples in dB */
                   int Nfft, 
                   codec2_fft_cfg fft_fwd_cfg,
-                  codec2_fft_cfg fft_inv_cfg
+                  codec2_fft_cfg fft_inv_cfg,
+                  COMP work[]                /* MAG_TO_PHASE_SCRATCH(Nfft) work space          */
                   )
 {
-    COMP Sdb[Nfft], c[Nfft], cf[Nfft], Cf[Nfft];
+    COMP *Sdb = work, *c = &work[Nfft], *cf = &work[2*Nfft], *Cf = &work[3*Nfft];
     int  Ns = Nfft/2+1;
     int  i;
 
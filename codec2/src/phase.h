@@ -34,6 +34,8 @@
 void sample_phase(MODEL *model, COMP filter_phase[], COMP A[]);
 void phase_synth_zero_order(int n_samp, MODEL *model, float *ex_phase, COMP filter_phase[]);
 
-void mag_to_phase(float phase[], float Gdbfk[], int Nfft, codec2_fft_cfg fwd_cfg, codec2_fft_cfg inv_cfg);
+#define MAG_TO_PHASE_SCRATCH(Nfft) (4*(Nfft))  /* COMPs of work space needed by mag_to_phase() */
+
+void mag_to_phase(float phase[], float Gdbfk[], int Nfft, codec2_fft_cfg fwd_cfg, codec2_fft_cfg inv_cfg, COMP work[]);
 
 #endif
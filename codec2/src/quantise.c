@@ -39,6 +39,7 @@
 #include "codec2_fft.h"
 #include "phase.h"
 #include "mbest.h"
+#include "vq.h"
 
 #undef PROFILE
 #include "machdep.h"
@@ -52,7 +53,7 @@
 \*---------------------------------------------------------------------------*/
 
 float speech_to_uq_lsps(float lsp[], float ak[], float Sn[], float w[],
-			int m_pitch, int order);
+			int m_pitch, int order, float Wn[]);
 
 /*---------------------------------------------------------------------------*\
 
@@ -103,26 +104,11 @@ long quantise(const float * cb, float vec[], float w[], int k, int m, float *se)
 /* int     m;		size of codebook		*/
 /* float   *se;		accumulated squared error 	*/
 {
-   float   e;		/* current error		*/
    long	   besti;	/* best index so far		*/
    float   beste;	/* best error so far		*/
-   long	   j;
-   int     i;
-   float   diff;
 
-   besti = 0;
    beste = 1E32;
-   for(j=0; j<m; j++) {
-	e = 0.0;
-	for(i=0; i<k; i++) {
-	    diff = cb[j*k+i]-vec[i];
-	    e += (diff*w[i] * diff*w[i]);
-	}
-	if (e < beste) {
-	    beste = e;
-	    besti = j;
-	}
-   }
+   besti = vq_nearest(cb, k, k, m, vec, w, VQ_WEIGHT_SQ, &beste);
 
    *se += beste;
 
@@ -234,42 +220,16 @@ void compute_weights(const float *x, float *w, int ndim)
 
 int find_nearest(const float *codebook, int nb_entries, float *x, int ndim)
 {
-  int i, j;
   float min_dist = 1e15;
-  int nearest = 0;
 
-  for (i=0;i<nb_entries;i++)
-  {
-    float dist=0;
-    for (j=0;j<ndim;j++)
-      dist += (x[j]-codebook[i*ndim+j])*(x[j]-codebook[i*ndim+j]);
-    if (dist<min_dist)
-    {
-      min_dist = dist;
-      nearest = i;
-    }
-  }
-  return nearest;
+  return vq_nearest(codebook, ndim, ndim, nb_entries, x, NULL, VQ_WEIGHT, &min_dist);
 }
 
 int find_nearest_weighted(const float *codebook, int nb_entries, float *x, const float *w, int ndim)
 {
-  int i, j;
   float min_dist = 1e15;
-  int nearest = 0;
 
-  for (i=0;i<nb_entries;i++)
-  {
-    float dist=0;
-    for (j=0;j<ndim;j++)
-      dist += w[j]*(x[j]-codebook[i*ndim+j])*(x[j]-codebook[i*ndim+j]);
-    if (dist<min_dist)
-    {
-      min_dist = dist;
-      nearest = i;
-    }
-  }
-  return nearest;
+  return vq_nearest(codebook, ndim, ndim, nb_entries, x, w, VQ_WEIGHT, &min_dist);
 }
 
 void lspjvm_quantise(float *x, float *xq, int order)
@@ -718,7 +678,8 @@ float decode_log_Wo(C2CONST *c2const, int index, int bits)
 
   Analyse a windowed frame of time domain speech to determine LPCs
   which are the converted to LSPs for quantisation and transmission
-  over the channel.
+  over the channel.  Wn[] is m_pitch floats of work space for the
+  windowed speech.
 
 \*---------------------------------------------------------------------------*/
 
@@ -727,11 +688,11 @@ float speech_to_uq_lsps(float lsp[],
 		        float Sn[],
 		        float w[],
 		        int m_pitch,
-                        int   order
+                        int   order,
+			float Wn[]
 )
 {
     int   i, roots;
-    float Wn[m_pitch];
     float R[order+1];
     float e, E;
 
@@ -92,7 +92,8 @@ float speech_to_uq_lsps(float lsp[],
 		        float Sn[],
 		        float w[],
 		        int m_pitch,
-                        int   order
+                        int   order,
+			float Wn[]
 			);
 int check_lsp_order(float lsp[], int lpc_order);
 void bw_expand_lsps(float lsp[], int order, float min_sep_low, float min_sep_high);
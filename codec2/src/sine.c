@@ -40,6 +40,7 @@
 #include "kiss_fft.h"
 
 #define HPF_BETA 0.125
+#define HS_BLOCK 16             /* candidate pitches per harmonic sum pass */
 
 /*---------------------------------------------------------------------------*\
 
@@ -47,8 +48,9 @@
 
 \*---------------------------------------------------------------------------*/
 
-void hs_pitch_refinement(MODEL *model, COMP Sw[], float pmin, float pmax,
+void hs_pitch_refinement(MODEL *model, float Pw[], float pmin, float pmax,
 			 float pstep);
+static void band_sum4(const float x[], const int e[], float sum[]);
 
 /*---------------------------------------------------------------------------*\
 
@@ -300,20 +302,28 @@ void dft_speech(codec2_fftr_cfg fftr_fwd_cfg, COMP Sw[], float Sn[], float w[])
 void two_stage_pitch_refinement(C2CONST *c2const, MODEL *model, COMP Sw[])
 {
   float pmin,pmax,pstep;	/* pitch refinment minimum, maximum and step */
+  float Pw[FFT_ENC];		/* power spectrum of Sw[] */
+  int   i;
+
+  /* Both passes sum the same bins many times over, so compute the
+     power spectrum once */
+
+  for(i=0; i<FFT_ENC; i++)
+    Pw[i] = Sw[i].real*Sw[i].real + Sw[i].imag*Sw[i].imag;
 
   /* Coarse refinement */
 
   pmax = TWO_PI/model->Wo + 5;
   pmin = TWO_PI/model->Wo - 5;
   pstep = 1.0;
-  hs_pitch_refinement(model,Sw,pmin,pmax,pstep);
+  hs_pitch_refinement(model,Pw,pmin,pmax,pstep);
 
   /* Fine refinement */
 
   pmax = TWO_PI/model->Wo + 1;
   pmin = TWO_PI/model->Wo - 1;
   pstep = 0.25;
-  hs_pitch_refinement(model,Sw,pmin,pmax,pstep);
+  hs_pitch_refinement(model,Pw,pmin,pmax,pstep);
 
   /* Limit range */
 
@@ -339,21 +349,27 @@ void two_stage_pitch_refinement(C2CONST *c2const, MODEL *model, COMP Sw[])
 
  Harmonic sum pitch refinement function.
 
+ Candidate pitches are evaluated HS_BLOCK at a time, harmonic by
+ harmonic, so the inner loop runs across candidates and can be
+ vectorised.  Each candidate still sums its harmonics in order, so E
+ is the same as summing one candidate at a time.
+
+ model	current pitch estimate in model.Wo
+ Pw     power spectrum of Sw[]
  pmin   pitch search range minimum
  pmax	pitch search range maximum
  step   pitch search step size
- model	current pitch estimate in model.Wo
 
  model 	refined pitch estimate in model.Wo
 
 \*---------------------------------------------------------------------------*/
 
-void hs_pitch_refinement(MODEL *model, COMP Sw[], float pmin, float pmax, float pstep)
+void hs_pitch_refinement(MODEL *model, float Pw[], float pmin, float pmax, float pstep)
 {
   int m;		/* loop variable */
-  int b;		/* bin for current harmonic centre */
-  float E;		/* energy for current pitch*/
-  float Wo;		/* current "test" fundamental freq. */
+  int k, nk;		/* candidate index and number in block */
+  float E[HS_BLOCK];	/* energy for each candidate pitch */
+  float Wo[HS_BLOCK];	/* "test" fundamental freq. of each candidate */
   float Wom;		/* Wo that maximises E */
   float Em;		/* mamimum energy */
   float r, one_on_r;	/* number of rads/bin */
@@ -369,20 +385,28 @@ void hs_pitch_refinement(MODEL *model, COMP Sw[], float pmin, float pmax, float
 
   /* Determine harmonic sum for a range of Wo values */
 
-  for(p=pmin; p<=pmax; p+=pstep) {
-    E = 0.0;
-    Wo = TWO_PI/p;
+  p = pmin;
+  while(p<=pmax) {
+    for(nk=0; (nk<HS_BLOCK) && (p<=pmax); nk++, p+=pstep) {
+      E[nk] = 0.0;
+      Wo[nk] = TWO_PI/p;
+    }
 
     /* Sum harmonic magnitudes */
     for(m=1; m<=model->L; m++) {
-        b = (int)(m*Wo*one_on_r + 0.5);
-        E += Sw[b].real*Sw[b].real + Sw[b].imag*Sw[b].imag;
+      for(k=0; k<nk; k++) {
+        int b = (int)(m*Wo[k]*one_on_r + 0.5);
+        E[k] += Pw[b];
+      }
     }
+
     /* Compare to see if this is a maximum */
 
-    if (E > Em) {
-      Em = E;
-      Wom = Wo;
+    for(k=0; k<nk; k++) {
+      if (E[k] > Em) {
+        Em = E[k];
+        Wom = Wo[k];
+      }
     }
   }
 
@@ -402,36 +426,86 @@ void hs_pitch_refinement(MODEL *model, COMP Sw[], float pmin, float pmax, float
 void estimate_amplitudes(MODEL *model, COMP Sw[], float W[], int est_phase)
 {
   int   i,m;		/* loop variables */
-  int   am,bm;		/* bounds of current harmonic */
-  float den;		/* denominator of amplitude expression */
+  int   am[MAX_AMP+2];	/* band edges, harmonic m spans bins am[m] to am[m+1]-1 */
+  float Pw[FFT_ENC];	/* power spectrum */
+  float den[4];		/* denominator of amplitude expression */
 
   float r = TWO_PI/FFT_ENC;
   float one_on_r = 1.0/r;
 
-  for(m=1; m<=model->L; m++) {
-    /* Estimate ampltude of harmonic */
+  for(m=1; m<=model->L+1; m++)
+    am[m] = (int)((m - 0.5)*model->Wo*one_on_r + 0.5);
 
-    den = 0.0;
-    am = (int)((m - 0.5)*model->Wo*one_on_r + 0.5);
-    bm = (int)((m + 0.5)*model->Wo*one_on_r + 0.5);
+  for(i=0; i<FFT_ENC; i++)
+    Pw[i] = Sw[i].real*Sw[i].real + Sw[i].imag*Sw[i].imag;
 
-    for(i=am; i<bm; i++) {
-      den += Sw[i].real*Sw[i].real + Sw[i].imag*Sw[i].imag;
-    }
+  /* Estimate ampltude of harmonics, four bands at a time */
 
-    model->A[m] = sqrtf(den);
+  for(m=1; m+3<=model->L; m+=4) {
+    band_sum4(Pw, &am[m], den);
+    model->A[m]   = sqrtf(den[0]);
+    model->A[m+1] = sqrtf(den[1]);
+    model->A[m+2] = sqrtf(den[2]);
+    model->A[m+3] = sqrtf(den[3]);
+  }
+  for(; m<=model->L; m++) {
+    den[0] = 0.0;
+    for(i=am[m]; i<am[m+1]; i++)
+      den[0] += Pw[i];
+    model->A[m] = sqrtf(den[0]);
+  }
 
-    if (est_phase) {
-        int b = (int)(m*model->Wo/r + 0.5); /* DFT bin of centre of current harmonic */
+  if (est_phase) {
+    for(m=1; m<=model->L; m++) {
+      int b = (int)(m*model->Wo/r + 0.5); /* DFT bin of centre of current harmonic */
 
-        /* Estimate phase of harmonic, this is expensive in CPU for
-           embedded devicesso we make it an option */
+      /* Estimate phase of harmonic, this is expensive in CPU for
+         embedded devicesso we make it an option */
 
-        model->phi[m] = atan2f(Sw[b].imag,Sw[b].real);
+      model->phi[m] = atan2f(Sw[b].imag,Sw[b].real);
     }
   }
 }
 
+/*---------------------------------------------------------------------------*\
+
+  band_sum4()
+
+  Sums x[] over four adjacent bands, band k spans e[k] to e[k+1]-1.
+  The four sums are run side by side so they overlap rather than
+  waiting on each other, each band is still summed in order.
+  Adjacent harmonic bands differ in width by at most a bin, so only a
+  short tail is summed band by band.
+
+\*---------------------------------------------------------------------------*/
+
+static void band_sum4(const float x[], const int e[], float sum[])
+{
+  const float *x0 = &x[e[0]], *x1 = &x[e[1]], *x2 = &x[e[2]], *x3 = &x[e[3]];
+  int   w0 = e[1]-e[0], w1 = e[2]-e[1], w2 = e[3]-e[2], w3 = e[4]-e[3];
+  int   wmin, j;
+  float s0, s1, s2, s3;
+
+  wmin = w0;
+  if (w1 < wmin) wmin = w1;
+  if (w2 < wmin) wmin = w2;
+  if (w3 < wmin) wmin = w3;
+
+  s0 = s1 = s2 = s3 = 0.0;
+  for(j=0; j<wmin; j++) {
+    s0 += x0[j];
+    s1 += x1[j];
+    s2 += x2[j];
+    s3 += x3[j];
+  }
+  for(j=wmin; j<w0; j++) s0 += x0[j];
+  for(j=wmin; j<w1; j++) s1 += x1[j];
+  for(j=wmin; j<w2; j++) s2 += x2[j];
+  for(j=wmin; j<w3; j++) s3 += x3[j];
+
+  sum[0] = s0; sum[1] = s1; sum[2] = s2; sum[3] = s3;
+}
+
 /*---------------------------------------------------------------------------*\
 
   est_voicing_mbe()
@@ -450,7 +524,9 @@ float est_voicing_mbe(
                       float  W[]
                       )
 {
-    int   l,al,bl,m;    /* loop variables */
+    int   l,m;          /* loop variables */
+    int   al[MAX_AMP+2];  /* band edges, harmonic l spans bins al[l] to al[l+1]-1 */
+    const float *Wl;      /* W[] centred on current harmonic */
     COMP  Am;             /* amplitude sample for this band */
     int   offset;         /* centers Hw[] about current harmonic */
     float den;            /* denominator of Am expression */
@@ -474,20 +550,22 @@ float est_voicing_mbe(
 
     /* Just test across the harmonics in the first 1000 Hz */
 
+    for(l=1; l<=l_1000hz+1; l++)
+	al[l] = ceilf((l - 0.5)*Wo*FFT_ENC/TWO_PI);
+
     for(l=1; l<=l_1000hz; l++) {
 	Am.real = 0.0;
 	Am.imag = 0.0;
 	den = 0.0;
-	al = ceilf((l - 0.5)*Wo*FFT_ENC/TWO_PI);
-	bl = ceilf((l + 0.5)*Wo*FFT_ENC/TWO_PI);
 
 	/* Estimate amplitude of harmonic assuming harmonic is totally voiced */
 
         offset = FFT_ENC/2 - l*Wo*FFT_ENC/TWO_PI + 0.5;
-	for(m=al; m<bl; m++) {
-	    Am.real += Sw[m].real*W[offset+m];
-	    Am.imag += Sw[m].imag*W[offset+m];
-	    den += W[offset+m]*W[offset+m];
+        Wl = &W[offset];
+	for(m=al[l]; m<al[l+1]; m++) {
+	    Am.real += Sw[m].real*Wl[m];
+	    Am.imag += Sw[m].imag*Wl[m];
+	    den += Wl[m]*Wl[m];
         }
 
         Am.real = Am.real/den;
@@ -495,9 +573,9 @@ float est_voicing_mbe(
 
         /* Determine error between estimated harmonic and original */
 
-        for(m=al; m<bl; m++) {
-	    Ew.real = Sw[m].real - Am.real*W[offset+m];
-	    Ew.imag = Sw[m].imag - Am.imag*W[offset+m];
+        for(m=al[l]; m<al[l+1]; m++) {
+	    Ew.real = Sw[m].real - Am.real*Wl[m];
+	    Ew.imag = Sw[m].imag - Am.imag*Wl[m];
 	    error += Ew.real*Ew.real;
 	    error += Ew.imag*Ew.imag;
 	}
@@ -0,0 +1,397 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: vq.c
+  DATE CREATED: Oct 2026
+
+  Nearest neighbour search engine shared by the VQ quantisers.
+
+  Errors are computed VQ_LANES codebook entries at a time from the
+  rearranged (SoA) codebooks in vq_soa_codebooks[], with one lane per
+  entry.  Each lane sums its entry's error over the vector elements in
+  the same order as the scalar loops, so the errors, and therefore the
+  chosen entries, are bit identical to an exhaustive scalar search.
+
+  Most of each search is skipped.  The build time index bounds the
+  error of whole blocks from their projections on the codebook's
+  principal axis, and blocks that are searched stop early once no lane
+  can still win.  Neither bound ever drops an entry that could win.
+
+  On x86 the widest of AVX-512, AVX2 and the portable C kernel is
+  selected at run time.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <math.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "defines.h"
+#include "vq.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define VQ_X86 1
+#else
+#define VQ_X86 0
+#endif
+
+#define VQ_CHECK    4           /* elements between partial error checks  */
+#define VQ_LB_SCALE (1.0 - 1E-5) /* covers float rounding of the errors    */
+
+typedef int (*vq_block_fn)(const float *c, int ndim, const float vec[], const float w[],
+                           enum vq_error_form form, float bound, float e[]);
+
+/*---------------------------------------------------------------------------*\
+
+  vq_block_c()
+
+  Errors of the VQ_LANES entries in the SoA block c[], written to e[].
+  Every VQ_CHECK elements the search gives up on the block if the
+  partial error of every lane already exceeds bound, and returns 0.
+  Portable version, the fixed VQ_LANES inner loops vectorise with
+  whatever the compiler targets by default.
+
+\*---------------------------------------------------------------------------*/
+
+static int vq_block_c(const float *c, int ndim, const float vec[], const float w[],
+                      enum vq_error_form form, float bound, float e[])
+{
+    float acc[VQ_LANES];
+    int   i, l, over;
+
+    for(l=0; l<VQ_LANES; l++)
+        acc[l] = 0.0;
+
+    for(i=0; i<ndim; i++, c+=VQ_LANES) {
+        float x = vec[i];
+        float wi = w ? w[i] : 1.0;
+
+        if (form == VQ_WEIGHT_SQ) {
+            for(l=0; l<VQ_LANES; l++) {
+                float diff = c[l] - x;
+                acc[l] += diff*wi*diff*wi;
+            }
+        }
+        else {
+            for(l=0; l<VQ_LANES; l++) {
+                float diff = c[l] - x;
+                acc[l] += wi*diff*diff;
+            }
+        }
+
+        if ((i % VQ_CHECK) == VQ_CHECK-1 && i < ndim-1) {
+            over = 0;
+            for(l=0; l<VQ_LANES; l++)
+                over += !(acc[l] <= bound);
+            if (over == VQ_LANES)
+                return 0;
+        }
+    }
+
+    for(l=0; l<VQ_LANES; l++)
+        e[l] = acc[l];
+
+    return 1;
+}
+
+#if VQ_X86
+
+/* Multiplies and adds are kept separate (no FMA) so each lane rounds
+   exactly as the scalar code does. */
+
+__attribute__((target("avx2")))
+static int vq_block_avx2(const float *c, int ndim, const float vec[], const float w[],
+                         enum vq_error_form form, float bound, float e[])
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 b = _mm256_set1_ps(bound);
+    int    i;
+
+    for(i=0; i<ndim; i++, c+=VQ_LANES) {
+        __m256 x  = _mm256_set1_ps(vec[i]);
+        __m256 wi = _mm256_set1_ps(w ? w[i] : 1.0f);
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(c), x);
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(c + 8), x);
+
+        if (form == VQ_WEIGHT_SQ) {
+            d0 = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(d0, wi), d0), wi);
+            d1 = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(d1, wi), d1), wi);
+        }
+        else {
+            d0 = _mm256_mul_ps(_mm256_mul_ps(wi, d0), d0);
+            d1 = _mm256_mul_ps(_mm256_mul_ps(wi, d1), d1);
+        }
+        acc0 = _mm256_add_ps(acc0, d0);
+        acc1 = _mm256_add_ps(acc1, d1);
+
+        if ((i % VQ_CHECK) == VQ_CHECK-1 && i < ndim-1) {
+            __m256 le = _mm256_or_ps(_mm256_cmp_ps(acc0, b, _CMP_LE_OQ),
+                                     _mm256_cmp_ps(acc1, b, _CMP_LE_OQ));
+            if (_mm256_movemask_ps(le) == 0)
+                return 0;
+        }
+    }
+
+    _mm256_storeu_ps(e, acc0);
+    _mm256_storeu_ps(e + 8, acc1);
+
+    return 1;
+}
+
+__attribute__((target("avx512f")))
+static int vq_block_avx512(const float *c, int ndim, const float vec[], const float w[],
+                           enum vq_error_form form, float bound, float e[])
+{
+    __m512 acc = _mm512_setzero_ps();
+    __m512 b = _mm512_set1_ps(bound);
+    int    i;
+
+    for(i=0; i<ndim; i++, c+=VQ_LANES) {
+        __m512 x  = _mm512_set1_ps(vec[i]);
+        __m512 wi = _mm512_set1_ps(w ? w[i] : 1.0f);
+        __m512 d  = _mm512_sub_ps(_mm512_loadu_ps(c), x);
+
+        if (form == VQ_WEIGHT_SQ)
+            d = _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(d, wi), d), wi);
+        else
+            d = _mm512_mul_ps(_mm512_mul_ps(wi, d), d);
+        acc = _mm512_add_ps(acc, d);
+
+        if ((i % VQ_CHECK) == VQ_CHECK-1 && i < ndim-1)
+            if (_mm512_cmp_ps_mask(acc, b, _CMP_LE_OQ) == 0)
+                return 0;
+    }
+
+    _mm512_storeu_ps(e, acc);
+
+    return 1;
+}
+
+#endif
+
+static vq_block_fn vq_block_select(void)
+{
+#if VQ_X86
+    if (__builtin_cpu_supports("avx512f"))
+        return vq_block_avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return vq_block_avx2;
+#endif
+    return vq_block_c;
+}
+
+/* Selected once, encoders may search from several threads */
+
+static vq_block_fn    vq_block = NULL;
+static pthread_once_t vq_block_once = PTHREAD_ONCE_INIT;
+
+static void vq_block_init(void)
+{
+    vq_block = vq_block_select();
+}
+
+static const struct vq_soa *vq_soa_find(const float *cb)
+{
+    const struct vq_soa *p;
+
+    for(p=vq_soa_codebooks; p->book != NULL; p++)
+        if (p->book->cb == cb)
+            return p;
+
+    return NULL;
+}
+
+/* Offers entry j with error e to the nbest list, kept in order of
+   error then index.  Entries already on the list before the search
+   (best_j[] < 0) win ties, as they did in the sequential scan. */
+
+static void vq_offer(int nbest, float best_e[], int best_j[], float e, int j)
+{
+    int i;
+
+    if (!(e < best_e[nbest-1] || (e == best_e[nbest-1] && j < best_j[nbest-1])))
+        return;
+
+    for(i=nbest-1; i>0; i--) {
+        if (best_e[i-1] < e || (best_e[i-1] == e && best_j[i-1] < j))
+            break;
+        best_e[i] = best_e[i-1];
+        best_j[i] = best_j[i-1];
+    }
+    best_e[i] = e;
+    best_j[i] = j;
+}
+
+/*---------------------------------------------------------------------------*\
+
+  vq_search()
+
+  Finds the nbest codebook entries closest to vec[].  k is the codebook
+  dimension, only the first ndim elements of each entry are compared.
+  w may be NULL for equal weights.
+
+  On entry best_e[] holds nbest errors to beat in ascending order, with
+  best_j[] set to -1.  On return best_e[], best_j[] hold the nbest
+  smallest errors and their entries, lowest index first among equal
+  errors, exactly as an exhaustive scan with a strict < test would have
+  found them.  Slots no entry could beat keep best_j[] = -1.
+
+  Indexed codebooks are searched a block at a time outwards from the
+  block whose projections on the codebook's principal axis u[] are
+  closest to that of vec[].  By Cauchy-Schwarz, an entry c has error
+
+    e >= (u.(c - vec))^2 / sum(u[i]^2/w[i]^2)      (VQ_WEIGHT_SQ)
+    e >= (u.(c - vec))^2 / sum(u[i]^2/w[i])        (VQ_WEIGHT)
+
+  so blocks whose projection range is far enough from vec[] cannot
+  hold a better entry and are skipped, along with all blocks beyond
+  them.  Blocks that are searched are abandoned part way once every
+  lane's partial error exceeds the current nbest-th error.
+
+  The search is not warm started from the previous frame's choice.
+  The block nearest vec[] is searched first, and on speech it bounds
+  the search as tightly as the previous choice and its neighbours
+  would, so trying them first only adds work.
+
+\*---------------------------------------------------------------------------*/
+
+void vq_search(const float *cb, int k, int ndim, int m,
+               const float vec[], const float w[], enum vq_error_form form,
+               int nbest, float best_e[], int best_j[])
+{
+    const struct vq_soa *p = NULL;
+    const float         *soa = NULL;
+    const short         *index = NULL;
+    float                e[VQ_LANES], limit;
+    double               P = 0.0, U = 0.0, glo, ghi, gap;
+    int                  nblocks = 0, prune = 1, bound = 0;
+    int                  i, j, b, lo, hi;
+
+    pthread_once(&vq_block_once, vq_block_init);
+
+    /* Both bounds need every term of the error to be positive */
+
+    if (w != NULL)
+        for(i=0; i<ndim; i++)
+            if (!(w[i] > 0.0))
+                prune = 0;
+
+    if (k == 1) {
+        /* A single element codebook is already in SoA order */
+        soa = cb;
+        nblocks = m/VQ_LANES;
+    }
+    else if ((p = vq_soa_find(cb)) != NULL) {
+        soa = p->soa;
+        index = p->index;
+        nblocks = p->nblocks;
+        bound = prune && (p->ndim == ndim);
+    }
+
+    if (bound) {
+        for(i=0; i<ndim; i++) {
+            double wi = w ? w[i] : 1.0;
+
+            P += p->u[i]*vec[i];
+            if (form == VQ_WEIGHT_SQ)
+                U += p->u[i]*p->u[i]/(wi*wi);
+            else
+                U += p->u[i]*p->u[i]/wi;
+        }
+        bound = U > 0.0;
+    }
+
+    lo = -1; hi = 0;
+    if (bound) {
+        while(hi < nblocks-1 && p->pmax[hi] < P)
+            hi++;
+        lo = hi - 1;
+    }
+
+    while(hi < nblocks || lo >= 0) {
+        if (bound) {
+            /* visit the nearer side next, once its bound fails so does
+               every block left on either side */
+
+            glo = lo >= 0 ? P - p->pmax[lo] : HUGE_VAL;
+            ghi = hi < nblocks ? p->pmin[hi] - P : HUGE_VAL;
+            if (glo < ghi) {
+                b = lo--;
+                gap = glo;
+            }
+            else {
+                b = hi++;
+                gap = ghi;
+            }
+            if (gap < 0.0)
+                gap = 0.0;
+            if (gap*gap/U*VQ_LB_SCALE - 1E-30 > best_e[nbest-1])
+                break;
+        }
+        else
+            b = hi++;
+
+        limit = prune ? best_e[nbest-1] : INFINITY;
+        if (!vq_block(&soa[b*k*VQ_LANES], ndim, vec, w, form, limit, e))
+            continue;
+        for(i=0; i<VQ_LANES; i++) {
+            j = index ? index[b*VQ_LANES + i] : b*VQ_LANES + i;
+            if (j >= 0)
+                vq_offer(nbest, best_e, best_j, e[i], j);
+        }
+    }
+
+    /* Entries past the last whole block of an unindexed codebook */
+
+    for(j=nblocks*VQ_LANES; j<m; j++) {
+        float acc = 0.0;
+
+        for(i=0; i<ndim; i++) {
+            float diff = cb[j*k+i] - vec[i];
+            float wi = w ? w[i] : 1.0;
+
+            if (form == VQ_WEIGHT_SQ)
+                acc += diff*wi*diff*wi;
+            else
+                acc += wi*diff*diff;
+        }
+        vq_offer(nbest, best_e, best_j, acc, j);
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+
+  vq_nearest()
+
+  Returns the index of the first codebook entry with the smallest
+  error below *beste, or 0 if there is none.  *beste is updated to
+  that error.
+
+\*---------------------------------------------------------------------------*/
+
+int vq_nearest(const float *cb, int k, int ndim, int m,
+               const float vec[], const float w[], enum vq_error_form form, float *beste)
+{
+    int   bestj = -1;
+
+    vq_search(cb, k, ndim, m, vec, w, form, 1, beste, &bestj);
+
+    return bestj < 0 ? 0 : bestj;
+}
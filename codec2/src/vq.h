@@ -0,0 +1,72 @@
+/*---------------------------------------------------------------------------*\
+
+  FILE........: vq.h
+  DATE CREATED: Oct 2026
+
+  Nearest neighbour search engine shared by the VQ quantisers.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  All rights reserved.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License version 2.1, as
+  published by the Free Software Foundation.  This program is
+  distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __VQ__
+#define __VQ__
+
+#include "defines.h"
+
+#define VQ_LANES 16             /* codebook entries per SoA block          */
+
+/* How the error between a vector and a codebook entry is formed.  Each
+   is summed over the vector elements in order, so results are exactly
+   those of the scalar loops they replace. */
+
+enum vq_error_form {
+    VQ_WEIGHT_SQ,               /* (c-x)*w*(c-x)*w, quantise(), mbest_search() */
+    VQ_WEIGHT                   /* w*(x-c)*(x-c), find_nearest_weighted()      */
+};
+
+/* A codebook rearranged for vector search.  Entries are sorted by
+   their projection on u[], the principal axis of the first ndim
+   elements of the codebook, and grouped in blocks of VQ_LANES.  Within
+   a block element i of every entry is stored together:
+
+     soa[(b*k + i)*VQ_LANES + l] = cb[index[b*VQ_LANES + l]*k + i]
+
+   The last block is padded with index -1.  pmin[b] and pmax[b] are the
+   smallest and largest projections in block b.  These are written at
+   build time by generate_vq. */
+
+struct vq_soa {
+    const struct lsp_codebook *book;
+    int           ndim;
+    int           nblocks;
+    const float  *soa;
+    const short  *index;
+    const double *u;
+    const double *pmin;
+    const double *pmax;
+};
+
+extern const struct vq_soa vq_soa_codebooks[]; /* terminated by book == NULL */
+
+void vq_search(const float *cb, int k, int ndim, int m,
+               const float vec[], const float w[], enum vq_error_form form,
+               int nbest, float best_e[], int best_j[]);
+int vq_nearest(const float *cb, int k, int ndim, int m,
+               const float vec[], const float w[], enum vq_error_form form, float *beste);
+
+#endif
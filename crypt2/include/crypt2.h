@@ -23,6 +23,67 @@ struct AES_ctx
 
 void aes256ctr_set_key(struct AES_ctx* ctx, const uint8_t* key);
 void aes256ctr_xcrypt(struct AES_ctx* ctx, uint8_t* buf, const uint8_t* iv);
+void aes256ctr_xcrypt_multi(const struct AES_ctx* const* ctx, const uint8_t* const* in, uint8_t* const* out, const uint8_t* const* iv, unsigned int n);
+
+
+/****
+
+		AES Key Store - Expanded Round Keys by Key ID
+
+****/
+
+typedef struct aes_keystore_s * aes_keystore;
+
+aes_keystore aes_keystore_create(unsigned int _capacity);
+void aes_keystore_destroy(aes_keystore _q);
+int aes_keystore_add(aes_keystore _q, uint32_t _key_id, const uint8_t* _key);
+struct AES_ctx* aes_keystore_get(aes_keystore _q, uint32_t _key_id);
+
+
+/****
+
+		AES-CTR Keystream Generator
+
+****/
+
+// Keystream is generated ahead of time, AES_KS_BATCH blocks (frames) per batch.
+#define AES_KS_BATCH 8
+#define AES_KS_FRAMES 64    // Ring size in frames. Power of 2, multiple of AES_KS_BATCH.
+
+struct AES_keystream
+{
+  const struct AES_ctx* ctx;
+  uint8_t Nonce[14];
+  uint16_t Head;            // Frame Number of next block to be used.
+  uint16_t Tail;            // Frame Number of next block to be generated.
+  uint8_t Ring[AES_KS_FRAMES][AES_BLOCKLEN];
+};
+
+void aes256ctr_keystream_init(struct AES_keystream* ks, const struct AES_ctx* ctx, const uint8_t* nonce, uint16_t fn);
+unsigned int aes256ctr_keystream_fill(struct AES_keystream* ks);
+void aes256ctr_keystream_xcrypt(struct AES_keystream* ks, uint8_t* buf, uint16_t fn);
+
+
+/****
+
+		Scrambler - LFSR Stream Cipher
+
+****/
+
+// Sub Types. Match M17 Encryption Sub Type.
+#define SCRAMBLER_8 0
+#define SCRAMBLER_16 1
+#define SCRAMBLER_24 2
+
+struct scrambler_ctx
+{
+  unsigned int SubType;
+  uint32_t Mask;
+  uint32_t State;
+};
+
+int scrambler_init(struct scrambler_ctx* ctx, unsigned int subtype, uint32_t seed);
+void scrambler_xcrypt(struct scrambler_ctx* ctx, uint8_t* buf, unsigned int len);
 
 
 /****
@@ -32,6 +93,7 @@ void aes256ctr_xcrypt(struct AES_ctx* ctx, uint8_t* buf, const uint8_t* iv);
 ****/
 
 void get_nonce(char *_nonce, unsigned int _nonce_len);
+int get_random_bytes(char *_buf, const size_t _len);
 int get_m17_nonce(char *_nonce, const size_t _nonce_len);
 
 
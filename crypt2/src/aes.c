@@ -11,6 +11,18 @@
 #define Nk 8        // The number of 32 bit words in a key.
 #define Nr 14  
 
+// Blocks in flight for batched/multi-buffer encryption.
+#define AES_MULTI_LANES 8
+
+// AES-NI is selected at runtime on x86 builds with GCC/Clang.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AES_NI 1
+#include <wmmintrin.h>
+#include <pthread.h>
+#else
+#define AES_NI 0
+#endif
+
 
 /*****************************************************************************/
 /* Private variables:                                                        */
@@ -261,6 +273,99 @@ static void Cipher(state_t* state, const uint8_t* RoundKey)
   AddRoundKey(Nr, state, RoundKey);
 }
 
+// CipherBatch encrypts _n independent states, state[b] with RoundKey[b].
+// Rounds are applied across the whole batch before moving to the next round,
+// so independent blocks overlap in the pipeline.
+static void CipherBatch(state_t* state, unsigned int _n, const uint8_t* const* RoundKey)
+{
+  uint8_t round = 0;
+  unsigned int b;
+
+  for (b = 0; b < _n; ++b)
+    AddRoundKey(0, &state[b], RoundKey[b]);
+
+  for (round = 1; ; ++round)
+  {
+    for (b = 0; b < _n; ++b)
+    {
+      SubBytes(&state[b]);
+      ShiftRows(&state[b]);
+    }
+    if (round == Nr) {
+      break;
+    }
+    for (b = 0; b < _n; ++b)
+    {
+      MixColumns(&state[b]);
+      AddRoundKey(round, &state[b], RoundKey[b]);
+    }
+  }
+
+  for (b = 0; b < _n; ++b)
+    AddRoundKey(Nr, &state[b], RoundKey[b]);
+}
+
+
+#if AES_NI
+
+// CipherBatch using AES-NI. Up to AES_MULTI_LANES blocks are kept in flight so
+// the aesenc latency is hidden behind the other lanes.
+__attribute__((target("aes,sse2")))
+static void CipherBatchNI(state_t* state, unsigned int _n, const uint8_t* const* RoundKey)
+{
+  __m128i x[AES_MULTI_LANES];
+  unsigned int b, l, lanes;
+  uint8_t round;
+
+  for (b = 0; b < _n; b += lanes)
+  {
+    lanes = (_n - b) < AES_MULTI_LANES ? (_n - b) : AES_MULTI_LANES;
+
+    for (l = 0; l < lanes; ++l)
+      x[l] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)state[b + l]),
+                           _mm_loadu_si128((const __m128i*)RoundKey[b + l]));
+
+    for (round = 1; round < Nr; ++round)
+      for (l = 0; l < lanes; ++l)
+        x[l] = _mm_aesenc_si128(x[l], _mm_loadu_si128((const __m128i*)(RoundKey[b + l] + round * Nb * 4)));
+
+    for (l = 0; l < lanes; ++l)
+    {
+      x[l] = _mm_aesenclast_si128(x[l], _mm_loadu_si128((const __m128i*)(RoundKey[b + l] + Nr * Nb * 4)));
+      _mm_storeu_si128((__m128i*)state[b + l], x[l]);
+    }
+  }
+}
+
+#endif
+
+#if AES_NI
+// Selected once, batches may be encrypted from several threads.
+static int aesni = 0;
+static pthread_once_t aesni_once = PTHREAD_ONCE_INIT;
+
+static void AesniInit(void)
+{
+  aesni = __builtin_cpu_supports("aes") ? 1 : 0;
+}
+#endif
+
+// Select AES-NI when the CPU supports it, otherwise the portable C rounds.
+static void CipherBatchDispatch(state_t* state, unsigned int _n, const uint8_t* const* RoundKey)
+{
+#if AES_NI
+  pthread_once(&aesni_once, AesniInit);
+
+  if (aesni)
+  {
+    CipherBatchNI(state, _n, RoundKey);
+    return;
+  }
+#endif
+
+  CipherBatch(state, _n, RoundKey);
+}
+
 
 
 
@@ -288,4 +393,117 @@ void aes256ctr_xcrypt(struct AES_ctx* ctx, uint8_t* buf, const uint8_t* iv)
 	{
 		buf[i] = (buf[i] ^ buffer[i]);
 	}
-}
\ No newline at end of file
+}
+
+
+// Multi-buffer Encrypt/Decrypt. Each of the _n 16 Byte buffers has its own key and IV:
+// out[i] = in[i] ^ AES(ctx[i], iv[i]). in[i] may point to the same payload for fan-out,
+// and may equal out[i] to work in place.
+void aes256ctr_xcrypt_multi(const struct AES_ctx* const* ctx, const uint8_t* const* in, uint8_t* const* out, const uint8_t* const* iv, unsigned int n)
+{
+  state_t batch[AES_MULTI_LANES];
+  const uint8_t* keys[AES_MULTI_LANES];
+  unsigned int b, l, lanes;
+
+  for (b = 0; b < n; b += lanes)
+  {
+    lanes = (n - b) < AES_MULTI_LANES ? (n - b) : AES_MULTI_LANES;
+
+    for (l = 0; l < lanes; l++)
+    {
+      memcpy(batch[l], iv[b + l], AES_BLOCKLEN);
+      keys[l] = ctx[b + l]->RoundKey;
+    }
+
+    CipherBatchDispatch(batch, lanes, keys);
+
+    for (l = 0; l < lanes; l++)
+    {
+      const uint8_t* key = (const uint8_t*)batch[l];
+
+      for (int i = 0; i < AES_BLOCKLEN; i++)
+      {
+        out[b + l][i] = (in[b + l][i] ^ key[i]);
+      }
+    }
+  }
+}
+
+
+/*****************************************************************************/
+/* Keystream Generator:                                                      */
+/*****************************************************************************/
+
+// Counter block for Frame Number _fn. Nonce (14 Bytes) followed by Frame Number (2 Bytes).
+static void KeystreamCounter(uint8_t* block, const uint8_t* nonce, uint16_t fn)
+{
+  memcpy(block, nonce, 14);
+  block[14] = (fn >> 8) & 0xFF;
+  block[15] = (fn) & 0xFF;
+}
+
+// Start keystream for a new stream. _fn is the first Frame Number that will be encrypted.
+// Key must already be loaded into _ctx and must outlive the keystream.
+void aes256ctr_keystream_init(struct AES_keystream* ks, const struct AES_ctx* ctx, const uint8_t* nonce, uint16_t fn)
+{
+  ks->ctx = ctx;
+  memcpy(ks->Nonce, nonce, sizeof(ks->Nonce));
+  ks->Head = fn;
+  ks->Tail = fn;
+}
+
+// Top up the ring in batches of AES_KS_BATCH frames. Returns number of frames generated.
+// Call when idle (e.g. after a frame has been sent) to keep AES off the per frame path.
+unsigned int aes256ctr_keystream_fill(struct AES_keystream* ks)
+{
+  state_t batch[AES_KS_BATCH];
+  const uint8_t* keys[AES_KS_BATCH];
+  unsigned int generated = 0;
+
+  while ((uint16_t)(ks->Tail - ks->Head) <= (AES_KS_FRAMES - AES_KS_BATCH))
+  {
+    for (int b = 0; b < AES_KS_BATCH; b++)
+    {
+      KeystreamCounter((uint8_t*)batch[b], ks->Nonce, ks->Tail + b);
+      keys[b] = ks->ctx->RoundKey;
+    }
+
+    CipherBatchDispatch(batch, AES_KS_BATCH, keys);
+
+    for (int b = 0; b < AES_KS_BATCH; b++)
+      memcpy(ks->Ring[(uint16_t)(ks->Tail + b) % AES_KS_FRAMES], batch[b], AES_BLOCKLEN);
+
+    ks->Tail += AES_KS_BATCH;
+    generated += AES_KS_BATCH;
+  }
+
+  return generated;
+}
+
+// Encrypt/Decrypt 16 Byte buffer for Frame Number _fn using precomputed keystream.
+// Falls back to computing the block on demand if _fn is not the next frame in the ring.
+void aes256ctr_keystream_xcrypt(struct AES_keystream* ks, uint8_t* buf, uint16_t fn)
+{
+  uint8_t buffer[AES_BLOCKLEN];
+  const uint8_t* key;
+
+  if (fn == ks->Head && ks->Head != ks->Tail)
+  {
+    key = ks->Ring[fn % AES_KS_FRAMES];
+  }
+  else
+  {
+    // Out of sequence, discard ring and restart after this frame.
+    KeystreamCounter(buffer, ks->Nonce, fn);
+    Cipher((state_t*)buffer, ks->ctx->RoundKey);
+    key = buffer;
+    ks->Tail = fn + 1;
+  }
+
+  ks->Head = fn + 1;
+
+  for (int i = 0; i < AES_BLOCKLEN; i++)
+  {
+    buf[i] = (buf[i] ^ key[i]);
+  }
+}
@@ -0,0 +1,142 @@
+/****
+		AES Key Store. Expanded Round Keys indexed by Key ID. !!! mlock() Not Portable !!!
+****/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/mman.h>	// Not Portable
+
+#include "crypt2.h"
+
+
+#define KEYSTORE_ALIGN 64		// Cache line.
+#define KEYSTORE_EMPTY 0		// Slot index 0 marks an unused hash slot.
+
+// key store object
+struct aes_keystore_s {
+    unsigned int capacity;		// Maximum number of keys.
+    unsigned int count;			// Keys in arena.
+    int locked;					// Arena locked in RAM.
+
+    struct AES_ctx * arena;		// Expanded keys [capacity], cache aligned.
+
+    // Open addressing hash table (linear probing). Size is a power of 2, at least 2 x capacity.
+    unsigned int mask;
+    uint32_t * ids;				// Key ID per slot
+    unsigned int * slots;		// Arena index + 1 per slot, KEYSTORE_EMPTY if unused.
+};
+
+
+// Hash Key ID to start slot.
+static unsigned int keystore_hash(uint32_t _key_id, unsigned int _mask)
+{
+    _key_id ^= _key_id >> 16;
+    _key_id *= 0x7feb352d;
+    _key_id ^= _key_id >> 15;
+
+    return _key_id & _mask;
+}
+
+// Find slot holding _key_id, or the empty slot where it would be inserted.
+static unsigned int keystore_find(aes_keystore _q, uint32_t _key_id)
+{
+    unsigned int i = keystore_hash(_key_id, _q->mask);
+
+    while (_q->slots[i] != KEYSTORE_EMPTY && _q->ids[i] != _key_id)
+        i = (i + 1) & _q->mask;
+
+    return i;
+}
+
+
+// create key store for up to _capacity keys
+aes_keystore aes_keystore_create(unsigned int _capacity)
+{
+    // Hash table size (at least 2 x capacity, rounded up to a power of 2) must fit an unsigned int.
+    if (_capacity > UINT_MAX / 4)
+        return NULL;
+
+    aes_keystore q = (aes_keystore) malloc(sizeof(struct aes_keystore_s));
+
+    if (q == NULL)
+        return NULL;
+
+    q->capacity = _capacity;
+    q->count = 0;
+
+    unsigned int size = 2;
+    while (size < 2 * _capacity) size <<= 1;
+    q->mask = size - 1;
+
+    q->ids = (uint32_t*) calloc(size, sizeof(uint32_t));
+    q->slots = (unsigned int*) calloc(size, sizeof(unsigned int));
+
+    void * arena = NULL;
+    if (posix_memalign(&arena, KEYSTORE_ALIGN, _capacity * sizeof(struct AES_ctx)) != 0)
+        arena = NULL;
+    q->arena = arena;
+
+    if (q->ids == NULL || q->slots == NULL || q->arena == NULL) {
+        free(q->ids);
+        free(q->slots);
+        free(q->arena);
+        free(q);
+        return NULL;
+    }
+
+    // Keep round keys out of swap. Not fatal if RLIMIT_MEMLOCK is too low.
+    q->locked = (mlock(q->arena, _capacity * sizeof(struct AES_ctx)) == 0);
+
+    return q;
+}
+
+// destroy key store, clearing all key material
+void aes_keystore_destroy(aes_keystore _q)
+{
+    size_t len = _q->capacity * sizeof(struct AES_ctx);
+
+    // volatile so the clear is not optimised away.
+    volatile uint8_t * p = (volatile uint8_t*) _q->arena;
+    while (len--) *p++ = 0;
+
+    if (_q->locked)
+        munlock(_q->arena, _q->capacity * sizeof(struct AES_ctx));
+
+    free(_q->arena);
+    free(_q->ids);
+    free(_q->slots);
+    free(_q);
+}
+
+// Add or replace key _key_id. Key is expanded once here. Returns 0 on success, -1 if full.
+int aes_keystore_add(aes_keystore _q, uint32_t _key_id, const uint8_t* _key)
+{
+    unsigned int i = keystore_find(_q, _key_id);
+
+    if (_q->slots[i] == KEYSTORE_EMPTY) {
+
+        if (_q->count == _q->capacity)
+            return -1;
+
+        _q->ids[i] = _key_id;
+        _q->slots[i] = ++_q->count;
+    }
+
+    aes256ctr_set_key(&_q->arena[_q->slots[i] - 1], _key);
+
+    return 0;
+}
+
+// Get expanded key for _key_id. Returns NULL if not present.
+struct AES_ctx* aes_keystore_get(aes_keystore _q, uint32_t _key_id)
+{
+    unsigned int i = keystore_find(_q, _key_id);
+
+    if (_q->slots[i] == KEYSTORE_EMPTY)
+        return NULL;
+
+    return &_q->arena[_q->slots[i] - 1];
+}
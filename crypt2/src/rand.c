@@ -6,22 +6,174 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <errno.h>
 #include <time.h>		// Not Portable
+#include <pthread.h>
+#include <unistd.h>		// Not Portable
 #include <sys/random.h>	// Not Portable
 
 #include "crypt2.h"
 
 
-// Get Random Bytes.
+// ChaCha20 DRBG. Blocks generated per refill, first 32 Bytes become the next key (fast key erasure).
+#define DRBG_BLOCKS 8
+#define DRBG_BUF_LEN (DRBG_BLOCKS * 64)
+#define DRBG_RESEED_BYTES (1 << 20)		// Reseed from kernel after 1 MiB of output.
+
+// Per thread DRBG state. No locking required.
+struct drbg_state {
+    uint32_t key[8];
+    uint64_t counter;
+    uint8_t buf[DRBG_BUF_LEN];
+    unsigned int pos;					// Next unused Byte in buf.
+    unsigned int reseed;				// Bytes left before reseed. 0 forces reseed.
+    unsigned int fork_gen;				// fork_gen the state was seeded under.
+};
+
+static _Thread_local struct drbg_state drbg;
+
+// Bumped in the child of every fork. Compared with drbg.fork_gen, so detecting a fork needs no getpid() syscall.
+static unsigned int fork_gen = 1;
+static pthread_once_t fork_gen_once = PTHREAD_ONCE_INIT;
+
+static void fork_gen_child(void)
+{
+    fork_gen++;
+}
+
+static void fork_gen_init(void)
+{
+    pthread_atfork(NULL, NULL, fork_gen_child);
+}
+
+
+// Get Random Bytes from kernel. Retries on EINTR and partial reads.
 int _randombytes_linux_getrandom(void * const _buf, const size_t _size)
 {
-    int readnb;
+    uint8_t *p = _buf;
+    size_t left = _size;
+    ssize_t readnb;
+
+    while (left > 0) {
+        readnb = getrandom(p, left, 0);
+
+        if (readnb < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        p += readnb;
+        left -= readnb;
+    }
+
+    return 0;
+}
+
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define QUARTERROUND(a, b, c, d) \
+    a += b; d ^= a; d = ROTL32(d, 16); \
+    c += d; b ^= c; b = ROTL32(b, 12); \
+    a += b; d ^= a; d = ROTL32(d, 8);  \
+    c += d; b ^= c; b = ROTL32(b, 7);
+
+// ChaCha20 block function (RFC 8439), 64 Bit counter and zero nonce.
+static void chacha20_block(const uint32_t _key[8], uint64_t _counter, uint8_t _out[64])
+{
+    uint32_t in[16] = { 0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+                        _key[0], _key[1], _key[2], _key[3], _key[4], _key[5], _key[6], _key[7],
+                        (uint32_t)_counter, (uint32_t)(_counter >> 32), 0, 0 };
+    uint32_t x[16];
 
-    do {
-        readnb = getrandom(_buf, _size, 0);
-    } while (readnb < 0);
+    memcpy(x, in, sizeof(x));
 
-    return (readnb == (int) _size) - 1;
+    for (int i = 0; i < 10; i++) {
+        QUARTERROUND(x[0], x[4], x[8],  x[12]);
+        QUARTERROUND(x[1], x[5], x[9],  x[13]);
+        QUARTERROUND(x[2], x[6], x[10], x[14]);
+        QUARTERROUND(x[3], x[7], x[11], x[15]);
+        QUARTERROUND(x[0], x[5], x[10], x[15]);
+        QUARTERROUND(x[1], x[6], x[11], x[12]);
+        QUARTERROUND(x[2], x[7], x[8],  x[13]);
+        QUARTERROUND(x[3], x[4], x[9],  x[14]);
+    }
+
+    for (int i = 0; i < 16; i++) {
+        uint32_t v = x[i] + in[i];
+        _out[4*i + 0] = v & 0xFF;
+        _out[4*i + 1] = (v >> 8) & 0xFF;
+        _out[4*i + 2] = (v >> 16) & 0xFF;
+        _out[4*i + 3] = (v >> 24) & 0xFF;
+    }
+}
+
+// Refill buffer, replacing key with the first 32 Bytes of output.
+static int drbg_refill(void)
+{
+    if (drbg.reseed == 0) {
+        uint32_t seed[8];
+
+        if (_randombytes_linux_getrandom(seed, sizeof(seed)) != 0)
+            return -1;
+
+        // Mix seed into current key so a weak reseed cannot reduce state.
+        for (int i = 0; i < 8; i++)
+            drbg.key[i] ^= seed[i];
+
+        memset(seed, 0, sizeof(seed));
+        drbg.reseed = DRBG_RESEED_BYTES;
+    }
+
+    for (int i = 0; i < DRBG_BLOCKS; i++)
+        chacha20_block(drbg.key, drbg.counter++, drbg.buf + 64*i);
+
+    for (int i = 0; i < 8; i++)
+        drbg.key[i] = (uint32_t)drbg.buf[4*i] | ((uint32_t)drbg.buf[4*i + 1] << 8) |
+                      ((uint32_t)drbg.buf[4*i + 2] << 16) | ((uint32_t)drbg.buf[4*i + 3] << 24);
+
+    memset(drbg.buf, 0, 32);
+    drbg.pos = 32;
+
+    return 0;
+}
+
+// Get Random Bytes from per thread DRBG. Only calls the kernel when seeding/reseeding.
+int get_random_bytes(char *_buf, const size_t _len)
+{
+    size_t left = _len;
+
+    pthread_once(&fork_gen_once, fork_gen_init);
+
+    // A forked child inherits the parent's state. Drop it and seed a fresh key, or both would serve the same Bytes.
+    if (drbg.fork_gen != fork_gen) {
+        memset(&drbg, 0, sizeof(drbg));
+        drbg.pos = DRBG_BUF_LEN;
+        drbg.fork_gen = fork_gen;
+    }
+
+    while (left > 0) {
+
+        if (drbg.pos == DRBG_BUF_LEN || drbg.reseed == 0) {
+            if (drbg_refill() != 0)
+                return -1;
+        }
+
+        size_t n = DRBG_BUF_LEN - drbg.pos;
+        if (n > left) n = left;
+        if (n > drbg.reseed) n = drbg.reseed;
+
+        memcpy(_buf, drbg.buf + drbg.pos, n);
+        memset(drbg.buf + drbg.pos, 0, n);		// Served Bytes are never kept.
+
+        drbg.pos += n;
+        drbg.reseed -= n;
+        _buf += n;
+        left -= n;
+    }
+
+    return 0;
 }
 
 
@@ -42,16 +194,9 @@ int get_m17_nonce(char *_nonce, const size_t _nonce_len)
 	   	}
 
 	   	// Get remaining random Nonce including CTR_HIGH.
-	   	char randombytes[10];
-	   	memset(&randombytes[0], 0, sizeof(randombytes));
-
-	   	int ret = _randombytes_linux_getrandom(randombytes, sizeof(randombytes));
-
-	   	memcpy(_nonce + 4, randombytes, 10);
-
-	    return 0;
+	   	return get_random_bytes(_nonce + 4, 10);
 	}
 	else
 		return -1;
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,146 @@
+/****
+		Scrambler - 8, 16 and 24 Bit Fibonacci LFSR.
+****/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "crypt2.h"
+
+
+// Feedback taps and register size for each sub type.
+// 8 Bit  : x^8 + x^6 + x^5 + x^4 + 1
+// 16 Bit : x^16 + x^15 + x^13 + x^4 + 1
+// 24 Bit : x^24 + x^23 + x^22 + x^17 + 1
+static const uint32_t scrambler_taps[3] = { 0xB8, 0xD008, 0xE10000 };
+static const unsigned int scrambler_bytes[3] = { 1, 2, 3 };
+
+// Output Byte for each Byte of register state. The LFSR is linear, so the next
+// 8 output bits are the XOR of the table entries for each state Byte.
+// Built once, contexts may be initialised from several threads.
+static uint8_t scrambler_table[3][3][256];
+static pthread_once_t scrambler_table_once = PTHREAD_ONCE_INIT;
+
+#define SCRAMBLER_CHUNK 64		// Keystream Bytes generated before each XOR pass.
+
+
+// Reference single step. Returns output bit.
+static unsigned int scrambler_step(uint32_t *_state, uint32_t _taps, uint32_t _mask)
+{
+    unsigned int bit = __builtin_parity(*_state & _taps);
+
+    *_state = ((*_state << 1) | bit) & _mask;
+
+    return bit;
+}
+
+// Build Byte step tables from the bitwise reference.
+static void scrambler_tables_init(void)
+{
+    for (int t = 0; t < 3; t++)
+    {
+        uint32_t mask = (1UL << (8 * scrambler_bytes[t])) - 1;
+
+        for (unsigned int j = 0; j < scrambler_bytes[t]; j++)
+        {
+            for (unsigned int v = 0; v < 256; v++)
+            {
+                uint32_t state = (uint32_t)v << (8 * j);
+                uint8_t out = 0;
+
+                for (int k = 0; k < 8; k++)
+                    out = (out << 1) | scrambler_step(&state, scrambler_taps[t], mask);
+
+                scrambler_table[t][j][v] = out;
+            }
+        }
+    }
+}
+
+// Set sub type (SCRAMBLER_8/16/24) and seed. Seed must be non zero within the register size.
+int scrambler_init(struct scrambler_ctx* ctx, unsigned int subtype, uint32_t seed)
+{
+    if (subtype > SCRAMBLER_24)
+        return -1;
+
+    pthread_once(&scrambler_table_once, scrambler_tables_init);
+
+    ctx->SubType = subtype;
+    ctx->Mask = (1UL << (8 * scrambler_bytes[subtype])) - 1;
+    ctx->State = seed & ctx->Mask;
+
+    if (ctx->State == 0)
+        return -1;
+
+    return 0;
+}
+
+// Generate next _len Bytes of scrambler sequence, 8 bits per step.
+static void scrambler_sequence(struct scrambler_ctx* ctx, uint8_t* seq, unsigned int len)
+{
+    const uint8_t (*table)[256] = scrambler_table[ctx->SubType];
+    uint32_t state = ctx->State;
+    uint8_t out;
+
+    switch (scrambler_bytes[ctx->SubType])
+    {
+        case 1:
+            for (unsigned int i = 0; i < len; i++) {
+                out = table[0][state];
+                state = out;
+                seq[i] = out;
+            }
+            break;
+
+        case 2:
+            for (unsigned int i = 0; i < len; i++) {
+                out = table[0][state & 0xFF] ^ table[1][state >> 8];
+                state = ((state << 8) | out) & 0xFFFF;
+                seq[i] = out;
+            }
+            break;
+
+        case 3:
+            for (unsigned int i = 0; i < len; i++) {
+                out = table[0][state & 0xFF] ^ table[1][(state >> 8) & 0xFF] ^ table[2][state >> 16];
+                state = ((state << 8) | out) & 0xFFFFFF;
+                seq[i] = out;
+            }
+            break;
+    }
+
+    ctx->State = state;
+}
+
+// Scramble/Descramble _len Bytes. Sequence continues across calls.
+void scrambler_xcrypt(struct scrambler_ctx* ctx, uint8_t* buf, unsigned int len)
+{
+    uint8_t seq[SCRAMBLER_CHUNK];
+
+    while (len > 0)
+    {
+        unsigned int n = len < SCRAMBLER_CHUNK ? len : SCRAMBLER_CHUNK;
+        unsigned int i = 0;
+
+        scrambler_sequence(ctx, seq, n);
+
+        // XOR a word at a time. Fixed size copies vectorise and avoid alignment issues.
+        for (; i + 8 <= n; i += 8)
+        {
+            uint64_t a, b;
+            memcpy(&a, buf + i, 8);
+            memcpy(&b, seq + i, 8);
+            a ^= b;
+            memcpy(buf + i, &a, 8);
+        }
+
+        for (; i < n; i++)
+            buf[i] ^= seq[i];
+
+        buf += n;
+        len -= n;
+    }
+}
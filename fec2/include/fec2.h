@@ -3,6 +3,8 @@
 #ifndef __FEC2_H__
 #define __FEC2_H__
 
+#include <stdint.h>
+
 /****
 
 		Global Variables
@@ -14,6 +16,15 @@
 #define	V25POLYA	0x13 // 19
 #define	V25POLYB	0x1D // 29
 
+/* Viterbi (1/2 Rate, K=7) Polynomials */
+#define	V27POLYA	0x6D // 109
+#define	V27POLYB	0x4F // 79
+
+/* Viterbi (1/3 Rate, K=7) Polynomials */
+#define	V37POLYA	0x5B // 91
+#define	V37POLYB	0x65 // 101
+#define	V37POLYC	0x7D // 125
+
 
 /****
 
@@ -64,6 +75,159 @@ unsigned short crc16_m17(unsigned char *_msg, unsigned int _msg_len);
 
 
 
+/****
+
+		LICH Assembler - Late entry Link Setup from Sub Frame LICH Chunks
+
+****/
+
+#define LICH_LEN 30             // Link Setup including CRC (number of bytes)
+#define LICH_CHUNKS 5           // Chunks per LICH, chunk index is Frame Number % 5
+#define LICH_CHUNK_LEN 6        // Decoded chunk (number of bytes)
+#define LICH_CHUNK_ENC_LEN 12   // Golay(24,12) encoded chunk (number of bytes)
+#define LICH_CHUNK_ENC_BITS (8*LICH_CHUNK_ENC_LEN)
+
+typedef struct lich_assembler_s * lich_assembler;
+
+/* 
+ * Create LICH assembler. Keep one per received stream.
+ */
+lich_assembler lich_assembler_create(void);
+
+/* 
+ * Destroy LICH assembler.
+ */
+void lich_assembler_destroy(lich_assembler _q);
+
+/* 
+ * Clear all chunks, call at the start of a new stream.
+ */
+void lich_assembler_reset(lich_assembler _q);
+
+/* 
+ * Add an encoded LICH chunk (hard bits).
+ * 
+ * _q              :   LICH assembler
+ * _index          :   chunk index (Frame Number % 5)
+ * _chunk_enc      :   Golay(24,12) encoded chunk [size: 1 x 12]
+ * 
+ * Returns 1 once the LICH is complete and its CRC is valid. Repeated copies of a chunk are combined
+ * before decoding. Chunks are only decoded once all 5 are present, and not at all once the LICH is valid.
+ */
+int lich_assembler_add(lich_assembler _q, unsigned int _index, unsigned char *_chunk_enc);
+
+/* 
+ * Add an encoded LICH chunk as LLRs (> 0 favours 1), see lich_assembler_add.
+ * 
+ * _llr            :   LLRs of Golay(24,12) encoded chunk [size: 1 x 96]
+ */
+int lich_assembler_add_soft(lich_assembler _q, unsigned int _index, signed char *_llr);
+
+/* 
+ * Get assembled LICH. Returns 1 and copies LICH if valid, otherwise 0.
+ * 
+ * _lich           :   LICH including CRC [size: 1 x 30]
+ */
+int lich_assembler_get(lich_assembler _q, unsigned char *_lich);
+
+/* 
+ * Returns number of copies combined for chunk _index.
+ */
+unsigned int lich_assembler_get_copies(lich_assembler _q, unsigned int _index);
+
+
+
+/****
+
+		LDPC - Layered min-sum decoder for the codec2 HRA codes (HRA_112_112, HRAb_396_504, H_256_768_22)
+
+****/
+
+#define LDPC_LANES 16   // Codewords decoded in parallel (int8 SIMD lanes)
+
+typedef struct ldpc_s * ldpc;
+
+// Arguments of ldpc_create for a codec2 table, e.g. ldpc_create(LDPC_CODE(HRA_112_112)). Needs the table header.
+#define LDPC_CODE(name) name##_NUMBERROWSHCOLS, name##_NUMBERPARITYBITS, name##_MAX_ROW_WEIGHT, name##_H_rows
+
+/* 
+ * Create LDPC encoder/decoder.
+ * 
+ * _data_bits      :   data bits per codeword (NUMBERROWSHCOLS)
+ * _parity_bits    :   parity bits per codeword (NUMBERPARITYBITS)
+ * _max_row_weight :   data bits per check (MAX_ROW_WEIGHT)
+ * _H_rows         :   codec2 H_rows table [size: _parity_bits x _max_row_weight]
+ * 
+ * Returns NULL if memory could not be allocated.
+ */
+ldpc ldpc_create(unsigned int _data_bits, unsigned int _parity_bits, unsigned int _max_row_weight, const uint16_t *_H_rows);
+
+/* 
+ * Destroy LDPC object.
+ */
+void ldpc_destroy(ldpc _q);
+
+/* 
+ * Returns data bits and codeword bits (data followed by parity).
+ */
+unsigned int ldpc_get_data_bits(ldpc _q);
+unsigned int ldpc_get_code_bits(ldpc _q);
+
+/* 
+ * Returns iterations run by the last ldpc_decode_soft call, each covers LDPC_LANES codewords.
+ */
+unsigned int ldpc_get_iterations(ldpc _q);
+
+/* 
+ * Encodes one codeword.
+ * 
+ * _msg_dec        :   data, bits MSB first [size: 1 x (data bits + 7)/8]
+ * _msg_enc        :   codeword, bits MSB first [size: 1 x (code bits + 7)/8]
+ */
+void ldpc_encode(ldpc _q, unsigned char *_msg_dec, unsigned char *_msg_enc);
+
+/* 
+ * Decodes _n codewords of soft input.
+ * 
+ * _n              :   number of codewords
+ * _llr            :   LLR per codeword bit, > 0 favours 1 [size: _n x code bits]
+ * _msg_dec        :   decoded data [size: _n x (data bits + 7)/8]
+ * _max_iter       :   iteration limit, decoding stops early once all checks are satisfied
+ * 
+ * Returns number of codewords with all checks satisfied.
+ * Messages are int8, keep channel LLRs around +/-8 to +/-32 so posteriors rarely saturate at +/-127.
+ * codec2 LLRs (> 0 favours 0) must be negated.
+ */
+unsigned int ldpc_decode_soft(ldpc _q, unsigned int _n, signed char *_llr, unsigned char *_msg_dec, unsigned int _max_iter);
+
+
+
+/****
+
+		Randomizer (Data Whitening)
+
+****/
+
+#define RANDOMIZER_LEN 46   // Frame payload length following Sync Burst (number of bytes)
+
+extern const unsigned char randomizer_seq[RANDOMIZER_LEN];
+
+/* 
+ * Randomizes a message while writing it into a frame payload.
+ * 
+ * _offset         :   start position within the 46 byte frame payload
+ * _len            :   number of frame payload bytes to write
+ * _msg            :   message
+ * _msg_len        :   message length (number of bytes)
+ * _frame          :   frame payload output at _offset [size: 1 x _len]
+ * 
+ * Message is zero padded to _len before randomizing. _offset + _len must not exceed RANDOMIZER_LEN.
+ * The operation is symmetrical, randomizer_encode also de-randomizes a received frame.
+ */
+void randomizer_encode(unsigned int _offset, unsigned int _len, unsigned char *_msg, unsigned int _msg_len, unsigned char *_frame);
+
+
+
 /****
 
 		Interleaver - Source: liquid-dsp
@@ -138,13 +302,22 @@ void interleaver_decode(interleaver _q, unsigned char * _msg_enc, unsigned char
  * _msg_enc        :   encoded (interleaved) message
  * _msg_dec        :   decoded (un-interleaved) message
  * 
- * Encoded Message will be padded if required.
+ * Encoded Message will be padded if required. Soft bits are only moved, signed LLRs can be passed cast to unsigned char.
  */
 void interleaver_decode_soft(interleaver _q, unsigned char * _msg_enc, unsigned char * _msg_dec);
 
 
 
 
+/* 
+ * Internal batch methods. Table is built by interleaver_encode_batch/interleaver_decode_batch.
+ */
+unsigned int interleaver_get_len(interleaver _q);
+void interleaver_build_table(interleaver _q);
+void interleaver_execute_table(interleaver _q, int _decode, unsigned char * _msg_in, unsigned char * _msg_out);
+
+
+
 /****
 
 		Viterbi Convolution Encode/Decoder - Source: libfec
@@ -154,38 +327,51 @@ void interleaver_decode_soft(interleaver _q, unsigned char * _msg_enc, unsigned
 /*
  * Create a new instance of a Viterbi decoder.
  */
-void *create_viterbi(int len);
-//void *create_viterbi27(int len);
+void *create_viterbi25(int len);
+void *create_viterbi27(int len);
+void *create_viterbi37(int len);
 
 /*
  * Set polynomials.
  */
-void set_viterbi_polynomial(int polys[2]);
-//void set_viterbi27_polynomial(int polys[2]);
+void set_viterbi25_polynomial(int polys[2]);
+void set_viterbi27_polynomial(int polys[2]);
+void set_viterbi37_polynomial(int polys[3]);
 
 /*
  * Initialize Viterbi decoder for start of new frame.
  */
-int init_viterbi(void *vp, int starting_state);
-//int init_viterbi27(void *vp, int starting_state);
+int init_viterbi25(void *vp, int starting_state);
+int init_viterbi27(void *vp, int starting_state);
+int init_viterbi37(void *vp, int starting_state);
 
 /*
  * Update decoder with a block of demodulated symbols.
  */
-int update_viterbi_blk(void *vp, unsigned char sym[],int npairs);
-//int update_viterbi27_blk(void *vp, unsigned char sym[],int npairs);
+int update_viterbi25_blk(void *vp, unsigned char sym[],int npairs);
+int update_viterbi27_blk(void *vp, unsigned char sym[],int npairs);
+int update_viterbi37_blk(void *vp, unsigned char sym[],int npairs);
 
 /*
  * Viterbi chainback.
  */
-int chainback_viterbi(void *vp, unsigned char *data,unsigned int nbits,unsigned int endstate);
-//int chainback_viterbi27(void *vp, unsigned char *data,unsigned int nbits,unsigned int endstate);
+int chainback_viterbi25(void *vp, unsigned char *data,unsigned int nbits,unsigned int endstate);
+int chainback_viterbi27(void *vp, unsigned char *data,unsigned int nbits,unsigned int endstate);
+int chainback_viterbi37(void *vp, unsigned char *data,unsigned int nbits,unsigned int endstate);
 
 /*
  * Delete instance of a Viterbi decoder.
  */
-void delete_viterbi(void *vp);
-//void delete_viterbi27(void *vp);
+void delete_viterbi25(void *vp);
+void delete_viterbi27(void *vp);
+void delete_viterbi37(void *vp);
+
+/*
+ * Encode nbits of data and tail into soft symbols (0 or 255), R per bit.
+ */
+void encode_viterbi25(unsigned char *syms, unsigned char *data, unsigned int nbits);
+void encode_viterbi27(unsigned char *syms, unsigned char *data, unsigned int nbits);
+void encode_viterbi37(unsigned char *syms, unsigned char *data, unsigned int nbits);
 
 /* 
  * Create 256-entry odd-parity lookup table. Only needed for non-ia32 machines.
@@ -221,10 +407,24 @@ static inline int parity(int x){
 
 ****/
 
+// Soft input LLR of a bit with no information (erased or punctured).
+#define LLR_ERASURE 0
+
+// Viterbi decoder input of a bit with no information, midway between a hard 0 (0) and 1 (255).
+// Hard and soft decoding both push it for punctured bits, soft input is centred on it.
+#define VITERBI_ERASURE 127
+
 typedef enum {
     // M17 Punctured Codes
     CONV_25_P45_60,     
-    CONV_25_P33_40
+    CONV_25_P33_40,
+    CONV_25_P7_8,       // Packet Frames
+
+    // Unpunctured Codes
+    CONV_27,            // R=1/2 K=7
+    CONV_37,            // R=1/3 K=7
+
+    FEC_NUM_SCHEMES
 } fec_scheme;
 
 
@@ -263,11 +463,24 @@ float get_convolutional_rate(fec _fec);
 unsigned int get_convolutional_msg_len(fec _fec, unsigned int _dec_msg_len);
 
 
-// punctured convolutional codes
+// punctured convolutional codes, create returns NULL for an invalid scheme
 fec convolutional_punctured_create(fec_scheme _fs);
 void convolutional_punctured_destroy(fec _fec);
 void convolutional_punctured_encode(fec _fec, unsigned int _dec_msg_len, unsigned char *_msg_dec, unsigned char *_msg_enc);
 void convolutional_punctured_decode(fec _fec, unsigned int _dec_msg_len, unsigned char *_msg_enc, unsigned char *_msg_dec);
+
+/* 
+ * Decodes soft input (LLR per transmitted bit) with the Viterbi decoder.
+ * 
+ * _fec            :   fec object
+ * _dec_msg_len    :   decoded message length (number of bytes)
+ * _llr_enc        :   encoded message LLRs, one per transmitted (unpunctured) bit [size: 1 x 8*get_convolutional_msg_len()]
+ * _msg_dec        :   decoded message [size: 1 x _dec_msg_len]
+ * 
+ * LLR > 0 favours 1, LLR < 0 favours 0. LLR_ERASURE (0) marks a bit with no information.
+ * LLRs can be de-interleaved with interleaver_decode_soft first, it only moves values.
+ */
+void convolutional_punctured_decode_soft(fec _fec, unsigned int _dec_msg_len, signed char *_llr_enc, unsigned char *_msg_dec);
 void convolutional_punctured_setlength(fec _fec, unsigned int _dec_msg_len);
 
 /* 
@@ -276,9 +489,58 @@ void convolutional_punctured_setlength(fec _fec, unsigned int _dec_msg_len);
 void init_convolutional_v25(fec _fec);
 void init_convolutional_v25_p45_60(fec _fec);
 void init_convolutional_v25_p33_40(fec _fec);
+void init_convolutional_v25_p7_8(fec _fec);
+void init_convolutional_v27(fec _fec);
+void init_convolutional_v37(fec _fec);
 
 // Convolutional Puncturing Matrices       [R x P]
 extern int conv25p45_60_matrix[60];     // [2 x 30]
 extern int conv25p33_40_matrix[40];     // [2 x 20]
+extern int conv25p7_8_matrix[8];        // [2 x 4]
+extern int conv27_matrix[2];            // [2 x 1]
+extern int conv37_matrix[3];            // [3 x 1]
+
+
+
+/****
+
+		Batch Encode/Decode - Arrays of frames in one call, optionally split over a worker pool
+
+****/
+
+typedef struct fec_pool_s * fec_pool;
+
+/* 
+ * Create worker pool. The calling thread also works on every batch.
+ * 
+ * _num_threads    :   worker threads in addition to the calling thread
+ */
+fec_pool fec_pool_create(unsigned int _num_threads);
+
+/* 
+ * Destroy worker pool. Waits for workers to exit.
+ */
+void fec_pool_destroy(fec_pool _p);
+
+/* 
+ * Returns number of worker threads started.
+ */
+unsigned int fec_pool_get_num_threads(fec_pool _p);
+
+/* 
+ * Batch variants of the single frame functions. Frames are stored back to back,
+ * frame i of a buffer starts at i * (frame length).
+ * 
+ * _n              :   number of frames
+ * _p              :   worker pool, or NULL to run in the calling thread
+ * 
+ * Only one batch may run on a pool at a time. Small batches are run in the calling thread.
+ */
+void convolutional_punctured_encode_batch(fec _fec, unsigned int _dec_msg_len, unsigned char *_msg_dec, unsigned char *_msg_enc, unsigned int _n, fec_pool _p);
+void convolutional_punctured_decode_batch(fec _fec, unsigned int _dec_msg_len, unsigned char *_msg_enc, unsigned char *_msg_dec, unsigned int _n, fec_pool _p);
+void fec_golay2412_encode_batch(unsigned int _dec_msg_len, unsigned char *_msg_dec, unsigned char *_msg_enc, unsigned int _n, fec_pool _p);
+void fec_golay2412_decode_batch(unsigned int _dec_msg_len, unsigned char *_msg_enc, unsigned char *_msg_dec, unsigned int _n, fec_pool _p);
+void interleaver_encode_batch(interleaver _q, unsigned char *_msg_dec, unsigned char *_msg_enc, unsigned int _n, fec_pool _p);
+void interleaver_decode_batch(interleaver _q, unsigned char *_msg_enc, unsigned char *_msg_dec, unsigned int _n, fec_pool _p);
 
 #endif
\ No newline at end of file
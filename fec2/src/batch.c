@@ -0,0 +1,350 @@
+/****
+		Batch Encode/Decode - Arrays of frames in one call, optionally split over a worker pool.
+****/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "fec2.h"
+
+
+#define FEC_POOL_MIN_FRAMES 4   // Frames per thread below which a batch is run by the caller alone.
+
+typedef void (*fec_pool_job)(void *_arg, unsigned int _worker, unsigned int _start, unsigned int _end);
+
+// worker pool object
+struct fec_pool_s {
+    unsigned int num_threads;   // Worker threads, the calling thread is worker 0.
+    pthread_t *threads;
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+
+    unsigned long job_id;       // Incremented for every job.
+    unsigned int busy;          // Workers still running the current job.
+    int quit;
+
+    fec_pool_job job;
+    void *arg;
+    unsigned int n;
+    unsigned int workers;       // Workers the current job is split over.
+
+    fec *fecs;                  // Viterbi decoders per worker and scheme [num_threads+1 x FEC_NUM_SCHEMES]
+};
+
+struct fec_pool_worker {
+    fec_pool p;
+    unsigned int worker;
+};
+
+
+// Frames [start, end) of worker w.
+static void fec_pool_range(unsigned int _n, unsigned int _workers, unsigned int _w, unsigned int *_start, unsigned int *_end)
+{
+    *_start = (unsigned long)_n * _w / _workers;
+    *_end = (unsigned long)_n * (_w + 1) / _workers;
+}
+
+static void *fec_pool_thread(void *_arg)
+{
+    struct fec_pool_worker *w = _arg;
+    fec_pool p = w->p;
+    unsigned long seen = 0;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&p->lock);
+
+        while (!p->quit && p->job_id == seen)
+            pthread_cond_wait(&p->start, &p->lock);
+
+        if (p->quit) {
+            pthread_mutex_unlock(&p->lock);
+            break;
+        }
+
+        seen = p->job_id;
+        pthread_mutex_unlock(&p->lock);
+
+        if (w->worker < p->workers)
+        {
+            unsigned int start, end;
+            fec_pool_range(p->n, p->workers, w->worker, &start, &end);
+
+            p->job(p->arg, w->worker, start, end);
+        }
+
+        pthread_mutex_lock(&p->lock);
+
+        if (--p->busy == 0)
+            pthread_cond_signal(&p->done);
+
+        pthread_mutex_unlock(&p->lock);
+    }
+
+    free(w);
+
+    return NULL;
+}
+
+fec_pool fec_pool_create(unsigned int _num_threads)
+{
+    fec_pool p = (fec_pool) malloc(sizeof(struct fec_pool_s));
+
+    p->num_threads = 0;
+    p->threads = (pthread_t*) malloc((_num_threads ? _num_threads : 1) * sizeof(pthread_t));
+    p->fecs = (fec*) calloc((_num_threads + 1) * FEC_NUM_SCHEMES, sizeof(fec));
+
+    p->job_id = 0;
+    p->workers = 1;
+    p->busy = 0;
+    p->quit = 0;
+
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->start, NULL);
+    pthread_cond_init(&p->done, NULL);
+
+    for (unsigned int i = 0; i < _num_threads; i++)
+    {
+        struct fec_pool_worker *w = malloc(sizeof(struct fec_pool_worker));
+        w->p = p;
+        w->worker = i + 1;
+
+        if (pthread_create(&p->threads[i], NULL, fec_pool_thread, w) != 0) {
+            free(w);
+            break;
+        }
+
+        p->num_threads++;
+    }
+
+    return p;
+}
+
+void fec_pool_destroy(fec_pool _p)
+{
+    pthread_mutex_lock(&_p->lock);
+    _p->quit = 1;
+    pthread_cond_broadcast(&_p->start);
+    pthread_mutex_unlock(&_p->lock);
+
+    for (unsigned int i = 0; i < _p->num_threads; i++)
+        pthread_join(_p->threads[i], NULL);
+
+    for (unsigned int i = 0; i < (_p->num_threads + 1) * FEC_NUM_SCHEMES; i++)
+        if (_p->fecs[i] != NULL)
+            convolutional_punctured_destroy(_p->fecs[i]);
+
+    pthread_mutex_destroy(&_p->lock);
+    pthread_cond_destroy(&_p->start);
+    pthread_cond_destroy(&_p->done);
+
+    free(_p->fecs);
+    free(_p->threads);
+    free(_p);
+}
+
+unsigned int fec_pool_get_num_threads(fec_pool _p)
+{
+    return _p->num_threads;
+}
+
+// Returns number of workers a batch of _n frames is split over.
+static unsigned int fec_pool_workers(fec_pool _p, unsigned int _n)
+{
+    if (_p == NULL || _p->num_threads == 0 || _n < 2*FEC_POOL_MIN_FRAMES)
+        return 1;
+
+    unsigned int workers = _n / FEC_POOL_MIN_FRAMES;
+
+    return workers < _p->num_threads + 1 ? workers : _p->num_threads + 1;
+}
+
+// Run _job over _n frames, split over the pool if there is one. Returns once all frames are done.
+static void fec_pool_run(fec_pool _p, fec_pool_job _job, void *_arg, unsigned int _n)
+{
+    unsigned int workers = fec_pool_workers(_p, _n);
+
+    if (workers == 1) {
+        _job(_arg, 0, 0, _n);
+        return;
+    }
+
+    pthread_mutex_lock(&_p->lock);
+    _p->job = _job;
+    _p->arg = _arg;
+    _p->n = _n;
+    _p->workers = workers;
+    _p->busy = _p->num_threads;
+    _p->job_id++;
+    pthread_cond_broadcast(&_p->start);
+    pthread_mutex_unlock(&_p->lock);
+
+    unsigned int start, end;
+    fec_pool_range(_n, workers, 0, &start, &end);
+    _job(_arg, 0, start, end);
+
+    pthread_mutex_lock(&_p->lock);
+
+    while (_p->busy)
+        pthread_cond_wait(&_p->done, &_p->lock);
+
+    pthread_mutex_unlock(&_p->lock);
+}
+
+
+/*
+ * Convolutional
+ */
+
+struct conv_batch {
+    fec *fecs;                  // fec object per worker
+    unsigned int dec_len;
+    unsigned int enc_len;
+    unsigned char *in;
+    unsigned char *out;
+};
+
+static void conv_encode_job(void *_arg, unsigned int _worker, unsigned int _start, unsigned int _end)
+{
+    struct conv_batch *b = _arg;
+
+    (void)_worker;
+
+    for (unsigned int i = _start; i < _end; i++)
+        convolutional_punctured_encode(b->fecs[0], b->dec_len, b->in + (unsigned long)i*b->dec_len, b->out + (unsigned long)i*b->enc_len);
+}
+
+static void conv_decode_job(void *_arg, unsigned int _worker, unsigned int _start, unsigned int _end)
+{
+    struct conv_batch *b = _arg;
+
+    for (unsigned int i = _start; i < _end; i++)
+        convolutional_punctured_decode(b->fecs[_worker], b->dec_len, b->in + (unsigned long)i*b->enc_len, b->out + (unsigned long)i*b->dec_len);
+}
+
+void convolutional_punctured_encode_batch(fec _fec, unsigned int _dec_msg_len, unsigned char *_msg_dec, unsigned char *_msg_enc, unsigned int _n, fec_pool _p)
+{
+    struct conv_batch b = { &_fec, _dec_msg_len, get_convolutional_msg_len(_fec, _dec_msg_len), _msg_dec, _msg_enc };
+
+    // Parity table is built on first use, not from the workers.
+    parity(0);
+
+    fec_pool_run(_p, conv_encode_job, &b, _n);
+}
+
+void convolutional_punctured_decode_batch(fec _fec, unsigned int _dec_msg_len, unsigned char *_msg_enc, unsigned char *_msg_dec, unsigned int _n, fec_pool _p)
+{
+    unsigned int workers = fec_pool_workers(_p, _n);
+    fec fecs[workers];
+
+    // Each worker needs its own Viterbi decoder. Size them here so workers never allocate.
+    fecs[0] = _fec;
+    convolutional_punctured_setlength(_fec, _dec_msg_len);
+
+    for (unsigned int w = 1; w < workers; w++)
+    {
+        fec *q = &_p->fecs[w*FEC_NUM_SCHEMES + _fec->scheme];
+
+        if (*q == NULL)
+            *q = convolutional_punctured_create(_fec->scheme);
+
+        convolutional_punctured_setlength(*q, _dec_msg_len);
+        fecs[w] = *q;
+    }
+
+    struct conv_batch b = { fecs, _dec_msg_len, get_convolutional_msg_len(_fec, _dec_msg_len), _msg_enc, _msg_dec };
+
+    fec_pool_run(_p, conv_decode_job, &b, _n);
+}
+
+
+/*
+ * Golay(24,12)
+ */
+
+struct golay_batch {
+    unsigned int dec_len;
+    unsigned int enc_len;
+    unsigned char *in;
+    unsigned char *out;
+};
+
+static void golay_encode_job(void *_arg, unsigned int _worker, unsigned int _start, unsigned int _end)
+{
+    struct golay_batch *b = _arg;
+
+    (void)_worker;
+
+    for (unsigned int i = _start; i < _end; i++)
+        fec_golay2412_encode(b->dec_len, b->in + (unsigned long)i*b->dec_len, b->out + (unsigned long)i*b->enc_len);
+}
+
+static void golay_decode_job(void *_arg, unsigned int _worker, unsigned int _start, unsigned int _end)
+{
+    struct golay_batch *b = _arg;
+
+    (void)_worker;
+
+    for (unsigned int i = _start; i < _end; i++)
+        fec_golay2412_decode(b->dec_len, b->in + (unsigned long)i*b->enc_len, b->out + (unsigned long)i*b->dec_len);
+}
+
+void fec_golay2412_encode_batch(unsigned int _dec_msg_len, unsigned char *_msg_dec, unsigned char *_msg_enc, unsigned int _n, fec_pool _p)
+{
+    struct golay_batch b = { _dec_msg_len, fec_golay_get_enc_msg_len(_dec_msg_len), _msg_dec, _msg_enc };
+
+    fec_pool_run(_p, golay_encode_job, &b, _n);
+}
+
+void fec_golay2412_decode_batch(unsigned int _dec_msg_len, unsigned char *_msg_enc, unsigned char *_msg_dec, unsigned int _n, fec_pool _p)
+{
+    struct golay_batch b = { _dec_msg_len, fec_golay_get_enc_msg_len(_dec_msg_len), _msg_enc, _msg_dec };
+
+    fec_pool_run(_p, golay_decode_job, &b, _n);
+}
+
+
+/*
+ * Interleaver
+ */
+
+struct interleaver_batch {
+    interleaver q;
+    int decode;
+    unsigned char *in;
+    unsigned char *out;
+};
+
+static void interleaver_job(void *_arg, unsigned int _worker, unsigned int _start, unsigned int _end)
+{
+    struct interleaver_batch *b = _arg;
+    unsigned int n = interleaver_get_len(b->q);
+
+    (void)_worker;
+
+    for (unsigned int i = _start; i < _end; i++)
+        interleaver_execute_table(b->q, b->decode, b->in + (unsigned long)i*n, b->out + (unsigned long)i*n);
+}
+
+void interleaver_encode_batch(interleaver _q, unsigned char *_msg_dec, unsigned char *_msg_enc, unsigned int _n, fec_pool _p)
+{
+    struct interleaver_batch b = { _q, 0, _msg_dec, _msg_enc };
+
+    // Swap table is built once here, not from the workers.
+    interleaver_build_table(_q);
+
+    fec_pool_run(_p, interleaver_job, &b, _n);
+}
+
+void interleaver_decode_batch(interleaver _q, unsigned char *_msg_enc, unsigned char *_msg_dec, unsigned int _n, fec_pool _p)
+{
+    struct interleaver_batch b = { _q, 1, _msg_enc, _msg_dec };
+
+    interleaver_build_table(_q);
+
+    fec_pool_run(_p, interleaver_job, &b, _n);
+}
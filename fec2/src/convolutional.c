@@ -7,8 +7,14 @@
 
 fec convolutional_punctured_create(fec_scheme _fs)
 {
+    if (_fs >= FEC_NUM_SCHEMES)
+        return NULL;
+
     fec _fec = (fec) malloc(sizeof(struct fec_s));
 
+    if (_fec == NULL)
+        return NULL;
+
     _fec->scheme = _fs;
     _fec->rate = get_convolutional_rate(_fec);
 
@@ -16,6 +22,10 @@ fec convolutional_punctured_create(fec_scheme _fs)
 
         case CONV_25_P45_60:   init_convolutional_v25_p45_60(_fec);    break;
         case CONV_25_P33_40:   init_convolutional_v25_p33_40(_fec);    break;
+        case CONV_25_P7_8:     init_convolutional_v25_p7_8(_fec);      break;
+        case CONV_27:          init_convolutional_v27(_fec);           break;
+        case CONV_37:          init_convolutional_v37(_fec);           break;
+        default:               free(_fec);                             return NULL;
     }
 
     // convolutional-specific decoding
@@ -105,6 +115,15 @@ void convolutional_punctured_encode(fec _fec, unsigned int _dec_msg_len, unsigne
 }
 
 
+// run Viterbi decoder over depunctured soft bits in _fec->enc_bits
+static void convolutional_punctured_run(fec _fec, unsigned char *_msg_dec)
+{
+    _fec->init_viterbi(_fec->vp,0);
+    // TODO : check to see if this shouldn't be num_enc_bits (punctured)
+    _fec->update_viterbi_blk(_fec->vp, _fec->enc_bits, 8*_fec->num_dec_bytes+_fec->K-1);
+    _fec->chainback_viterbi(_fec->vp, _msg_dec, 8*_fec->num_dec_bytes, 0);
+}
+
 void convolutional_punctured_decode(fec _fec, unsigned int _dec_msg_len, unsigned char *_msg_enc, unsigned char *_msg_dec)
 {
     // re-allocate resources if necessary
@@ -134,17 +153,45 @@ void convolutional_punctured_decode(fec _fec, unsigned int _dec_msg_len, unsigne
                 }
             } else {
                 // push erasure
-                _fec->enc_bits[i+r] = 127;
+                _fec->enc_bits[i+r] = VITERBI_ERASURE;
             }
         }
         p = (p+1) % _fec->P;
     }
 
     // run decoder
-    _fec->init_viterbi(_fec->vp,0);
-    // TODO : check to see if this shouldn't be num_enc_bits (punctured)
-    _fec->update_viterbi_blk(_fec->vp, _fec->enc_bits, 8*_fec->num_dec_bytes+_fec->K-1);
-    _fec->chainback_viterbi(_fec->vp, _msg_dec, 8*_fec->num_dec_bytes, 0);
+    convolutional_punctured_run(_fec, _msg_dec);
+}
+
+void convolutional_punctured_decode_soft(fec _fec, unsigned int _dec_msg_len, signed char *_llr_enc, unsigned char *_msg_dec)
+{
+    // re-allocate resources if necessary
+    convolutional_punctured_setlength(_fec, _dec_msg_len);
+
+    // offset LLRs into decoder metric range, adding erasures at punctured indices
+    unsigned int num_dec_bits = _fec->num_dec_bytes * 8 + _fec->K - 1;
+    unsigned int num_enc_bits = num_dec_bits * _fec->R;
+    unsigned int i,r;
+    unsigned int n=0;   // input LLR index
+    unsigned int p=0;   // puncturing matrix column index
+    for (i=0; i<num_enc_bits; i+=_fec->R) {
+        //
+        for (r=0; r<_fec->R; r++) {
+            if (_fec->puncturing_matrix[r*(_fec->P)+p]) {
+                // push LLR from input, -127..127 to 0..254 (-128 is taken as -127)
+                int llr = _llr_enc[n++];
+                if (llr < -VITERBI_ERASURE) llr = -VITERBI_ERASURE;
+                _fec->enc_bits[i+r] = (unsigned char)(VITERBI_ERASURE + llr);
+            } else {
+                // push erasure
+                _fec->enc_bits[i+r] = VITERBI_ERASURE + LLR_ERASURE;
+            }
+        }
+        p = (p+1) % _fec->P;
+    }
+
+    // run decoder
+    convolutional_punctured_run(_fec, _msg_dec);
 }
 
 
@@ -185,6 +232,10 @@ float get_convolutional_rate(fec _fec)
     switch (_fec->scheme) {
         case CONV_25_P45_60:    return 45./60.;
         case CONV_25_P33_40:    return 33./40.;
+        case CONV_25_P7_8:      return 7./8.;
+        case CONV_27:           return 1.;
+        case CONV_37:           return 1.;
+        default:                return 0.;
     }
 }
 
@@ -208,6 +259,7 @@ unsigned int get_convolutional_msg_len(fec _fec, unsigned int _dec_msg_len)
 
 /* 
  * Internal initialization methods (sets r, K, viterbi methods, and puncturing matrix.
+ * Viterbi decoders are generated per code, see viterbi_gen.c.
  */
 
 int convolutional_v25_poly[2]  = {V25POLYA, V25POLYB};
@@ -215,15 +267,14 @@ int convolutional_v25_poly[2]  = {V25POLYA, V25POLYB};
 
 void init_convolutional_v25(fec _fec)
 {
-	/* !! Matching Rate and Contraint required in viterbi.c !! */
     _fec->R=2;
     _fec->K=5;
     _fec->poly = convolutional_v25_poly;
-    _fec->create_viterbi = create_viterbi;
-    _fec->init_viterbi = init_viterbi;
-    _fec->update_viterbi_blk = update_viterbi_blk;
-    _fec->chainback_viterbi = chainback_viterbi;
-    _fec->delete_viterbi = delete_viterbi;
+    _fec->create_viterbi = create_viterbi25;
+    _fec->init_viterbi = init_viterbi25;
+    _fec->update_viterbi_blk = update_viterbi25_blk;
+    _fec->chainback_viterbi = chainback_viterbi25;
+    _fec->delete_viterbi = delete_viterbi25;
 }
 
 void init_convolutional_v25_p45_60(fec _fec)
@@ -240,4 +291,50 @@ void init_convolutional_v25_p33_40(fec _fec)
 
     _fec->P = 20;
     _fec->puncturing_matrix = conv25p33_40_matrix;
+}
+
+void init_convolutional_v25_p7_8(fec _fec)
+{
+    init_convolutional_v25(_fec);
+
+    _fec->P = 4;
+    _fec->puncturing_matrix = conv25p7_8_matrix;
+}
+
+
+/* 
+ * Unpunctured codes.
+ */
+
+int convolutional_v27_poly[2]  = {V27POLYA, V27POLYB};
+int convolutional_v37_poly[3]  = {V37POLYA, V37POLYB, V37POLYC};
+
+void init_convolutional_v27(fec _fec)
+{
+    _fec->R=2;
+    _fec->K=7;
+    _fec->poly = convolutional_v27_poly;
+    _fec->create_viterbi = create_viterbi27;
+    _fec->init_viterbi = init_viterbi27;
+    _fec->update_viterbi_blk = update_viterbi27_blk;
+    _fec->chainback_viterbi = chainback_viterbi27;
+    _fec->delete_viterbi = delete_viterbi27;
+
+    _fec->P = 1;
+    _fec->puncturing_matrix = conv27_matrix;
+}
+
+void init_convolutional_v37(fec _fec)
+{
+    _fec->R=3;
+    _fec->K=7;
+    _fec->poly = convolutional_v37_poly;
+    _fec->create_viterbi = create_viterbi37;
+    _fec->init_viterbi = init_viterbi37;
+    _fec->update_viterbi_blk = update_viterbi37_blk;
+    _fec->chainback_viterbi = chainback_viterbi37;
+    _fec->delete_viterbi = delete_viterbi37;
+
+    _fec->P = 1;
+    _fec->puncturing_matrix = conv37_matrix;
 }
\ No newline at end of file
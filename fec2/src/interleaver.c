@@ -52,8 +52,15 @@ struct interleaver_s {
 
     // interleaving depth (number of permutations)
     unsigned int depth;
+
+    // swap indices of each permutation [4 x n/2], built for batches
+    unsigned int * swap;
 };
 
+// permutation column offsets and masks, see interleaver_encode()
+static const unsigned int interleaver_col_offset[4] = { 0, 2, 4, 8 };
+static const unsigned char interleaver_mask[4] = { 0xff, 0x0f, 0x55, 0x33 };
+
 // create interleaver of length _n input/output bytes
 interleaver interleaver_create(unsigned int _n)
 {
@@ -69,6 +76,8 @@ interleaver interleaver_create(unsigned int _n)
     q->N = q->n / q->M;
     while (q->n >= (q->M*q->N)) q->N++;  // ensures M*N >= n
 
+    q->swap = NULL;
+
     return q;
 }
 
@@ -76,6 +85,7 @@ interleaver interleaver_create(unsigned int _n)
 void interleaver_destroy(interleaver _q)
 {
     // free main object memory
+    free(_q->swap);
     free(_q);
 }
 
@@ -154,6 +164,75 @@ void interleaver_decode_soft(interleaver _q, unsigned char * _msg_enc, unsigned
     if (_q->depth > 0) interleaver_permute_soft(_msg_dec, _q->n, _q->M, _q->N);
 }
 
+// get length (number of bytes)
+unsigned int interleaver_get_len(interleaver _q)
+{
+    return _q->n;
+}
+
+// build swap index table once, so batches skip the index search
+void interleaver_build_table(interleaver _q)
+{
+    if (_q->swap != NULL)
+        return;
+
+    unsigned int n2 = _q->n/2;
+    _q->swap = (unsigned int*) malloc((4*n2 + 1)*sizeof(unsigned int));
+
+    unsigned int p;
+    for (p=0; p<4; p++) {
+        unsigned int i;
+        unsigned int j;
+        unsigned int m=0;
+        unsigned int n=_q->n/3;
+        unsigned int N=_q->N + interleaver_col_offset[p];
+
+        for (i=0; i<n2; i++) {
+            do {
+                j = m*N + n; // output
+                m++;
+                if (m == _q->M) {
+                    n = (n+1) % N;
+                    m=0;
+                }
+            } while (j>=n2);
+
+            _q->swap[p*n2+i] = j;
+        }
+    }
+}
+
+// execute interleaver from swap table (see interleaver_build_table)
+//  _q          :   interleaver object
+//  _decode     :   0 forward (encoder), 1 reverse (decoder)
+//  _msg_in     :   input message
+//  _msg_out    :   output message
+void interleaver_execute_table(interleaver _q, int _decode, unsigned char * _msg_in, unsigned char * _msg_out)
+{
+    unsigned int n2 = _q->n/2;
+    unsigned int depth = _q->depth < 4 ? _q->depth : 4;
+
+    // copy data to output
+    memmove(_msg_out, _msg_in, _q->n);
+
+    unsigned int k;
+    for (k=0; k<depth; k++) {
+        unsigned int p = _decode ? depth-1-k : k;
+        const unsigned int * swap = _q->swap + p*n2;
+        unsigned char mask = interleaver_mask[p];
+
+        unsigned int i;
+        for (i=0; i<n2; i++) {
+            unsigned char * a = &_msg_out[2*i+0];
+            unsigned char * b = &_msg_out[2*swap[i]+1];
+            unsigned char tmp0 = (*a & (~mask)) | (*b & ( mask));
+            unsigned char tmp1 = (*a & ( mask)) | (*b & (~mask));
+            *a = tmp0;
+            *b = tmp1;
+        }
+    }
+}
+
 // 
 // internal permutation methods
 //
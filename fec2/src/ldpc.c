@@ -0,0 +1,366 @@
+/****
+		LDPC - Layered min-sum decoder and encoder for Hybrid Repeat Accumulate (HRA) codes.
+
+		Parity check tables are in the codec2 format (H_rows, generated by ldpc_gen_c_h_file.m):
+		H_rows[i + j*parity_bits] is the 1-based data bit of the j-th connection of check i.
+		The parity part of H is the implicit dual diagonal, check i also connects parity bits i-1 and i.
+
+		LDPC_LANES codewords are decoded at once, one per int8 SIMD lane, with the same schedule.
+****/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "fec2.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+#define LDPC_LLR_MAX 127    // Messages are clamped to +/-127, so negating never overflows.
+
+// No offset or scaling correction. Every hop along the accumulator (degree 2 parity bits) applies it again,
+// which cost more than it gained on all three codec2 codes.
+
+
+/*
+ * int8 vector operations, 1 lane per codeword.
+ */
+
+#if defined(__SSE2__)
+
+typedef __m128i ldpc_vec;
+
+static inline ldpc_vec v_zero(void)                     { return _mm_setzero_si128(); }
+static inline ldpc_vec v_set(int8_t _x)                 { return _mm_set1_epi8(_x); }
+static inline ldpc_vec v_adds(ldpc_vec _a, ldpc_vec _b) { return _mm_adds_epi8(_a, _b); }
+static inline ldpc_vec v_subs(ldpc_vec _a, ldpc_vec _b) { return _mm_subs_epi8(_a, _b); }
+static inline ldpc_vec v_xor(ldpc_vec _a, ldpc_vec _b)  { return _mm_xor_si128(_a, _b); }
+static inline ldpc_vec v_or(ldpc_vec _a, ldpc_vec _b)   { return _mm_or_si128(_a, _b); }
+static inline ldpc_vec v_neg_mask(ldpc_vec _a)          { return _mm_cmpgt_epi8(_mm_setzero_si128(), _a); }  // -1 where < 0
+static inline ldpc_vec v_eq(ldpc_vec _a, ldpc_vec _b)   { return _mm_cmpeq_epi8(_a, _b); }
+static inline ldpc_vec v_minu(ldpc_vec _a, ldpc_vec _b) { return _mm_min_epu8(_a, _b); }
+static inline ldpc_vec v_maxu(ldpc_vec _a, ldpc_vec _b) { return _mm_max_epu8(_a, _b); }
+static inline ldpc_vec v_select(ldpc_vec _m, ldpc_vec _a, ldpc_vec _b) { return _mm_or_si128(_mm_and_si128(_m, _a), _mm_andnot_si128(_m, _b)); }
+static inline unsigned int v_signs(ldpc_vec _a)         { return _mm_movemask_epi8(_a); }
+static inline ldpc_vec v_load_lanes(const int8_t *_x)   { return _mm_loadu_si128((const __m128i*)_x); }
+
+#else
+
+typedef struct { int8_t v[LDPC_LANES]; } ldpc_vec;
+
+#define V_LANES(expr) { ldpc_vec r; for (int l = 0; l < LDPC_LANES; l++) r.v[l] = (expr); return r; }
+
+static inline int8_t sat8(int _x) { return _x > 127 ? 127 : (_x < -128 ? -128 : _x); }
+
+static inline ldpc_vec v_zero(void)                     V_LANES(0)
+static inline ldpc_vec v_set(int8_t _x)                 V_LANES(_x)
+static inline ldpc_vec v_adds(ldpc_vec _a, ldpc_vec _b) V_LANES(sat8(_a.v[l] + _b.v[l]))
+static inline ldpc_vec v_subs(ldpc_vec _a, ldpc_vec _b) V_LANES(sat8(_a.v[l] - _b.v[l]))
+static inline ldpc_vec v_xor(ldpc_vec _a, ldpc_vec _b)  V_LANES(_a.v[l] ^ _b.v[l])
+static inline ldpc_vec v_or(ldpc_vec _a, ldpc_vec _b)   V_LANES(_a.v[l] | _b.v[l])
+static inline ldpc_vec v_neg_mask(ldpc_vec _a)          V_LANES(_a.v[l] < 0 ? -1 : 0)
+static inline ldpc_vec v_eq(ldpc_vec _a, ldpc_vec _b)   V_LANES(_a.v[l] == _b.v[l] ? -1 : 0)
+static inline ldpc_vec v_minu(ldpc_vec _a, ldpc_vec _b) V_LANES((uint8_t)_a.v[l] < (uint8_t)_b.v[l] ? _a.v[l] : _b.v[l])
+static inline ldpc_vec v_maxu(ldpc_vec _a, ldpc_vec _b) V_LANES((uint8_t)_a.v[l] > (uint8_t)_b.v[l] ? _a.v[l] : _b.v[l])
+static inline ldpc_vec v_select(ldpc_vec _m, ldpc_vec _a, ldpc_vec _b) V_LANES(_m.v[l] ? _a.v[l] : _b.v[l])
+
+static inline unsigned int v_signs(ldpc_vec _a)
+{
+    unsigned int m = 0;
+    for (int l = 0; l < LDPC_LANES; l++)
+        m |= (_a.v[l] < 0) << l;
+    return m;
+}
+
+static inline ldpc_vec v_load_lanes(const int8_t *_x)   { ldpc_vec r; memcpy(r.v, _x, LDPC_LANES); return r; }
+
+#endif
+
+// |_a|, saturates -128 to 127.
+static inline ldpc_vec v_abs(ldpc_vec _a)
+{
+    ldpc_vec m = v_neg_mask(_a);
+    return v_subs(v_xor(_a, m), m);
+}
+
+
+// ldpc object
+struct ldpc_s {
+    unsigned int data_bits;
+    unsigned int parity_bits;
+    unsigned int code_bits;
+
+    // Checks in compressed row form.
+    unsigned int *row_ptr;      // [parity_bits + 1]
+    unsigned int *col;          // [num_edges] bit index of each edge
+    unsigned int num_edges;
+    unsigned int max_degree;
+
+    // Decoder state for LDPC_LANES codewords.
+    ldpc_vec *L;                // posterior LLR per bit [code_bits]
+    ldpc_vec *R;                // check to bit message per edge [num_edges]
+    ldpc_vec *Q;                // bit to check messages of current check [max_degree]
+    uint16_t *hard;             // decided bits, one lane per bit [code_bits]
+
+    unsigned int iterations;    // Iterations run by last decode call.
+};
+
+
+ldpc ldpc_create(unsigned int _data_bits, unsigned int _parity_bits, unsigned int _max_row_weight, const uint16_t *_H_rows)
+{
+    // Zeroed so a partly built object can be freed by ldpc_destroy.
+    ldpc q = (ldpc) calloc(1, sizeof(struct ldpc_s));
+
+    if (q == NULL)
+        return NULL;
+
+    q->data_bits = _data_bits;
+    q->parity_bits = _parity_bits;
+    q->code_bits = _data_bits + _parity_bits;
+
+    // Build checks - data bits from H_rows, then the dual diagonal.
+    q->row_ptr = (unsigned int*) malloc((_parity_bits + 1) * sizeof(unsigned int));
+    q->col = (unsigned int*) malloc(_parity_bits * (_max_row_weight + 2) * sizeof(unsigned int));
+    q->num_edges = 0;
+    q->max_degree = 0;
+
+    if (q->row_ptr == NULL || q->col == NULL) {
+        ldpc_destroy(q);
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < _parity_bits; i++)
+    {
+        q->row_ptr[i] = q->num_edges;
+
+        for (unsigned int j = 0; j < _max_row_weight; j++)
+            if (_H_rows[i + j*_parity_bits] > 0)
+                q->col[q->num_edges++] = _H_rows[i + j*_parity_bits] - 1;
+
+        if (i > 0)
+            q->col[q->num_edges++] = _data_bits + i - 1;
+
+        q->col[q->num_edges++] = _data_bits + i;
+
+        if (q->num_edges - q->row_ptr[i] > q->max_degree)
+            q->max_degree = q->num_edges - q->row_ptr[i];
+    }
+
+    q->row_ptr[_parity_bits] = q->num_edges;
+
+    // SIMD state, aligned for vector loads.
+    void *L = NULL, *R = NULL, *Q = NULL;
+
+    if (posix_memalign(&L, 16, q->code_bits * sizeof(ldpc_vec)) != 0) L = NULL;
+    if (posix_memalign(&R, 16, q->num_edges * sizeof(ldpc_vec)) != 0) R = NULL;
+    if (posix_memalign(&Q, 16, q->max_degree * sizeof(ldpc_vec)) != 0) Q = NULL;
+
+    q->L = L;
+    q->R = R;
+    q->Q = Q;
+    q->hard = (uint16_t*) malloc(q->code_bits * sizeof(uint16_t));
+    q->iterations = 0;
+
+    if (q->L == NULL || q->R == NULL || q->Q == NULL || q->hard == NULL) {
+        ldpc_destroy(q);
+        return NULL;
+    }
+
+    return q;
+}
+
+void ldpc_destroy(ldpc _q)
+{
+    free(_q->row_ptr);
+    free(_q->col);
+    free(_q->L);
+    free(_q->R);
+    free(_q->Q);
+    free(_q->hard);
+    free(_q);
+}
+
+unsigned int ldpc_get_data_bits(ldpc _q)
+{
+    return _q->data_bits;
+}
+
+unsigned int ldpc_get_code_bits(ldpc _q)
+{
+    return _q->code_bits;
+}
+
+unsigned int ldpc_get_iterations(ldpc _q)
+{
+    return _q->iterations;
+}
+
+void ldpc_encode(ldpc _q, unsigned char *_msg_dec, unsigned char *_msg_enc)
+{
+    memset(_msg_enc, 0, (_q->code_bits + 7) / 8);
+
+    // Data bits are sent unchanged
+    for (unsigned int i = 0; i < _q->data_bits; i++)
+        if ((_msg_dec[i/8] >> (7 - i%8)) & 0x01)
+            _msg_enc[i/8] |= 0x80 >> (i%8);
+
+    // Accumulate parity, check i: p[i] = p[i-1] ^ data bits of check i
+    unsigned int p = 0;
+
+    for (unsigned int i = 0; i < _q->parity_bits; i++)
+    {
+        for (unsigned int e = _q->row_ptr[i]; e < _q->row_ptr[i+1]; e++)
+        {
+            unsigned int c = _q->col[e];
+
+            if (c < _q->data_bits)
+                p ^= (_msg_dec[c/8] >> (7 - c%8)) & 0x01;
+        }
+
+        unsigned int b = _q->data_bits + i;
+
+        if (p)
+            _msg_enc[b/8] |= 0x80 >> (b%8);
+    }
+}
+
+// Returns lanes with all checks satisfied by the current hard decisions (sign bit set = bit 1).
+static unsigned int ldpc_syndrome(ldpc _q)
+{
+    ldpc_vec fail = v_zero();
+
+    for (unsigned int i = 0; i < _q->parity_bits; i++)
+    {
+        ldpc_vec s = v_zero();
+
+        for (unsigned int e = _q->row_ptr[i]; e < _q->row_ptr[i+1]; e++)
+            s = v_xor(s, _q->L[_q->col[e]]);
+
+        fail = v_or(fail, s);
+    }
+
+    return ~v_signs(fail) & ((1u << LDPC_LANES) - 1);
+}
+
+// One layered min-sum iteration, check by check.
+static void ldpc_iterate(ldpc _q)
+{
+    ldpc_vec *Q = _q->Q;
+
+    for (unsigned int i = 0; i < _q->parity_bits; i++)
+    {
+        unsigned int e0 = _q->row_ptr[i];
+        unsigned int d = _q->row_ptr[i+1] - e0;
+        ldpc_vec *R = _q->R + e0;
+        const unsigned int *col = _q->col + e0;
+
+        ldpc_vec min1 = v_set(LDPC_LLR_MAX);
+        ldpc_vec min2 = v_set(LDPC_LLR_MAX);
+        ldpc_vec sign = v_zero();
+
+        // Bit to check messages, two smallest magnitudes and sign product.
+        for (unsigned int k = 0; k < d; k++)
+        {
+            ldpc_vec x = v_subs(_q->L[col[k]], R[k]);
+            ldpc_vec a = v_abs(x);
+            min2 = v_minu(min2, v_maxu(min1, a));
+            min1 = v_minu(min1, a);
+            sign = v_xor(sign, x);
+
+            Q[k] = x;
+        }
+
+        // Check to bit messages (smallest other magnitude), update posteriors.
+        for (unsigned int k = 0; k < d; k++)
+        {
+            ldpc_vec m = v_select(v_eq(v_abs(Q[k]), min1), min2, min1);
+            ldpc_vec s = v_neg_mask(v_xor(sign, Q[k]));
+
+            R[k] = v_subs(v_xor(m, s), s);
+            _q->L[col[k]] = v_adds(Q[k], R[k]);
+        }
+    }
+}
+
+// Decode up to LDPC_LANES codewords, returns lanes with all checks satisfied.
+static unsigned int ldpc_decode_lanes(ldpc _q, unsigned int _n, signed char *_llr, unsigned int _max_iter)
+{
+    int8_t lanes[LDPC_LANES];
+
+    // Load LLRs, negated so the sign bit is the hard decision (bit 1). Unused lanes are all zero, a valid codeword.
+    for (unsigned int b = 0; b < _q->code_bits; b++)
+    {
+        for (unsigned int l = 0; l < LDPC_LANES; l++)
+        {
+            int x = l < _n ? -_llr[l*_q->code_bits + b] : 0;
+            lanes[l] = x > LDPC_LLR_MAX ? LDPC_LLR_MAX : x;
+        }
+
+        _q->L[b] = v_load_lanes(lanes);
+    }
+
+    memset(_q->R, 0, _q->num_edges * sizeof(ldpc_vec));
+
+    unsigned int done = 0;
+    unsigned int all = (1u << LDPC_LANES) - 1;
+
+    for (unsigned int it = 0; ; it++)
+    {
+        // Keep decisions of lanes the first time all their checks are satisfied (early termination per lane).
+        unsigned int valid = ldpc_syndrome(_q);
+        unsigned int newly = valid & ~done;
+
+        if (newly)
+        {
+            for (unsigned int b = 0; b < _q->code_bits; b++)
+                _q->hard[b] = (_q->hard[b] & ~newly) | (v_signs(_q->L[b]) & newly);
+
+            done |= newly;
+        }
+
+        if (done == all || it == _max_iter)
+            break;
+
+        ldpc_iterate(_q);
+        _q->iterations++;
+    }
+
+    // Lanes that never converged keep their last decisions.
+    if (done != all)
+        for (unsigned int b = 0; b < _q->code_bits; b++)
+            _q->hard[b] = (_q->hard[b] & done) | (v_signs(_q->L[b]) & ~done);
+
+    return done;
+}
+
+unsigned int ldpc_decode_soft(ldpc _q, unsigned int _n, signed char *_llr, unsigned char *_msg_dec, unsigned int _max_iter)
+{
+    unsigned int data_bytes = (_q->data_bits + 7) / 8;
+    unsigned int valid = 0;
+
+    _q->iterations = 0;
+
+    for (unsigned int f = 0; f < _n; f += LDPC_LANES)
+    {
+        unsigned int n = _n - f < LDPC_LANES ? _n - f : LDPC_LANES;
+        unsigned int done = ldpc_decode_lanes(_q, n, _llr + (unsigned long)f*_q->code_bits, _max_iter);
+
+        for (unsigned int l = 0; l < n; l++)
+        {
+            unsigned char *msg = _msg_dec + (unsigned long)(f + l)*data_bytes;
+            memset(msg, 0, data_bytes);
+
+            for (unsigned int b = 0; b < _q->data_bits; b++)
+                if ((_q->hard[b] >> l) & 0x01)
+                    msg[b/8] |= 0x80 >> (b%8);
+
+            valid += (done >> l) & 0x01;
+        }
+    }
+
+    return valid;
+}
@@ -0,0 +1,131 @@
+/****
+		LICH Assembler - Rebuilds the Link Setup from Golay(24,12) encoded LICH Chunks in Sub Frames.
+****/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fec2.h"
+
+
+#define LICH_LLR_HARD 64		// LLR given to each bit of a hard decision chunk.
+#define LICH_ACC_MAX 32000		// Combined LLR limit.
+
+// lich assembler object
+struct lich_assembler_s {
+    short acc[LICH_CHUNKS][LICH_CHUNK_ENC_BITS];		// Combined LLRs of every copy of each chunk.
+    unsigned int copies[LICH_CHUNKS];					// Copies combined per chunk.
+    unsigned char chunk[LICH_CHUNKS][LICH_CHUNK_LEN];	// Decoded chunks.
+    unsigned char dirty[LICH_CHUNKS];					// Chunk changed since last decode.
+
+    int valid;											// LICH complete and CRC valid.
+    unsigned char lich[LICH_LEN];
+};
+
+
+lich_assembler lich_assembler_create(void)
+{
+    lich_assembler q = (lich_assembler) malloc(sizeof(struct lich_assembler_s));
+
+    lich_assembler_reset(q);
+
+    return q;
+}
+
+void lich_assembler_destroy(lich_assembler _q)
+{
+    free(_q);
+}
+
+void lich_assembler_reset(lich_assembler _q)
+{
+    memset(_q, 0, sizeof(struct lich_assembler_s));
+}
+
+// Decode changed chunks once all are present and check CRC.
+static int lich_assembler_check(lich_assembler _q)
+{
+    for (int c = 0; c < LICH_CHUNKS; c++)
+        if (_q->copies[c] == 0)
+            return 0;
+
+    for (int c = 0; c < LICH_CHUNKS; c++)
+    {
+        if (!_q->dirty[c])
+            continue;
+
+        // Hard decision on combined LLRs, then Golay decode.
+        unsigned char enc[LICH_CHUNK_ENC_LEN];
+        memset(enc, 0, sizeof(enc));
+
+        for (int i = 0; i < LICH_CHUNK_ENC_BITS; i++)
+            if (_q->acc[c][i] > 0)
+                enc[i/8] |= 0x80 >> (i%8);
+
+        fec_golay2412_decode(LICH_CHUNK_LEN, enc, _q->chunk[c]);
+        _q->dirty[c] = 0;
+    }
+
+    for (int c = 0; c < LICH_CHUNKS; c++)
+        memcpy(_q->lich + LICH_CHUNK_LEN*c, _q->chunk[c], LICH_CHUNK_LEN);
+
+    unsigned short crc = crc16_m17(_q->lich, LICH_LEN - 2);
+
+    _q->valid = (_q->lich[LICH_LEN - 2] == ((crc >> 8) & 0xFF)) && (_q->lich[LICH_LEN - 1] == (crc & 0xFF));
+
+    return _q->valid;
+}
+
+int lich_assembler_add_soft(lich_assembler _q, unsigned int _index, signed char *_llr)
+{
+    // Nothing left to do once the LICH is valid.
+    if (_q->valid)
+        return 1;
+
+    if (_index >= LICH_CHUNKS)
+        return 0;
+
+    for (int i = 0; i < LICH_CHUNK_ENC_BITS; i++)
+    {
+        int v = _q->acc[_index][i] + _llr[i];
+
+        if (v > LICH_ACC_MAX) v = LICH_ACC_MAX;
+        if (v < -LICH_ACC_MAX) v = -LICH_ACC_MAX;
+
+        _q->acc[_index][i] = v;
+    }
+
+    _q->copies[_index]++;
+    _q->dirty[_index] = 1;
+
+    return lich_assembler_check(_q);
+}
+
+int lich_assembler_add(lich_assembler _q, unsigned int _index, unsigned char *_chunk_enc)
+{
+    signed char llr[LICH_CHUNK_ENC_BITS];
+
+    if (_q->valid)
+        return 1;
+
+    for (int i = 0; i < LICH_CHUNK_ENC_BITS; i++)
+        llr[i] = ((_chunk_enc[i/8] >> (7 - i%8)) & 0x01) ? LICH_LLR_HARD : -LICH_LLR_HARD;
+
+    return lich_assembler_add_soft(_q, _index, llr);
+}
+
+int lich_assembler_get(lich_assembler _q, unsigned char *_lich)
+{
+    if (!_q->valid)
+        return 0;
+
+    memcpy(_lich, _q->lich, LICH_LEN);
+
+    return 1;
+}
+
+unsigned int lich_assembler_get_copies(lich_assembler _q, unsigned int _index)
+{
+    return _index < LICH_CHUNKS ? _q->copies[_index] : 0;
+}
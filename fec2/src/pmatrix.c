@@ -8,4 +8,12 @@ int conv25p45_60_matrix[60] = { 1, 1, 1, 0, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1,
 
 // 1/2 Rate Puncturing Matrix 7 of 40 Bits Punctured.
 int conv25p33_40_matrix[40] = { 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 1, 
-                                1, 0, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 0, 1, 1 };
\ No newline at end of file
+                                1, 0, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 0, 1, 1 };
+
+// 1/2 Rate Puncturing Matrix 1 of 8 Bits Punctured. Packet Frames.
+int conv25p7_8_matrix[8] = { 1, 1, 1, 1,
+                             1, 1, 1, 0 };
+
+// 1/2 Rate and 1/3 Rate Unpunctured. K=7 codes.
+int conv27_matrix[2] = { 1, 1 };
+int conv37_matrix[3] = { 1, 1, 1 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+/****
+		Randomizer (Data Whitening).
+****/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "fec2.h"
+
+// M17 Randomizer sequence, applied to the 368 bit (46 Byte) frame payload following the Sync Burst.
+const unsigned char randomizer_seq[RANDOMIZER_LEN] = {
+    0xD6, 0xB5, 0xE2, 0x30, 0x82, 0xFF, 0x84, 0x62, 0xBA, 0x4E, 0x96, 0x90, 0xD8, 0x98, 0xDD, 0x5D,
+    0x0C, 0xC8, 0x52, 0x43, 0x91, 0x1D, 0xF8, 0x6E, 0x68, 0x2F, 0x35, 0xDA, 0x14, 0xEA, 0xCD, 0x76,
+    0x19, 0x8D, 0xD5, 0x80, 0xD1, 0x33, 0x87, 0x13, 0x57, 0x18, 0x2D, 0x29, 0x78, 0xC3 };
+
+
+void randomizer_encode(unsigned int _offset, unsigned int _len, unsigned char *_msg, unsigned int _msg_len, unsigned char *_frame)
+{
+    const unsigned char *seq = randomizer_seq + _offset;
+    unsigned int n = _msg_len < _len ? _msg_len : _len;
+    unsigned int i = 0;
+
+    // 32 Bytes at a time. Fixed size copies vectorise and avoid alignment issues.
+    for (; i + 32 <= n; i += 32)
+    {
+        uint64_t m[4], s[4];
+        memcpy(m, _msg + i, 32);
+        memcpy(s, seq + i, 32);
+        m[0] ^= s[0];
+        m[1] ^= s[1];
+        m[2] ^= s[2];
+        m[3] ^= s[3];
+        memcpy(_frame + i, m, 32);
+    }
+
+    for (; i < n; i++)
+        _frame[i] = _msg[i] ^ seq[i];
+
+    // Padding is zero before randomizing.
+    for (; i < _len; i++)
+        _frame[i] = seq[i];
+}
@@ -0,0 +1,206 @@
+/* Specialized Viterbi decoder and encoder prototype
+ * Based on r=1/2 Viterbi decoder in portable C
+ * Copyright Feb 2004, Phil Karn, KA9Q
+ * May be used under the terms of the GNU Lesser General Public License (LGPL)
+ *
+ * Included by viterbi_gen.c once per code with these defined:
+ *
+ *  VITERBI(pre,post)  :   name mangling, e.g. pre##27##post
+ *  VITERBI_K       :   constraint length
+ *  VITERBI_RATE    :   primitive rate, inverted (e.g. 2 for 1/2)
+ *  VITERBI_POLYS   :   polynomials { A, B, ... }, first and last tap must be set on every polynomial
+ *
+ * All loop bounds are constants, so the compiler unrolls the butterflies and branch metrics.
+ */
+
+#define VNUMSTATES (1 << (VITERBI_K-1))
+#define VMAXMETRIC (255*VITERBI_RATE)
+#define VDECWORDS ((VNUMSTATES+31)/32)
+
+static int VITERBI(polys,)[VITERBI_RATE] = VITERBI_POLYS;
+
+static unsigned char VITERBI(Branchtab,)[VITERBI_RATE][VNUMSTATES/2] __attribute__ ((aligned(16)));
+
+static int VITERBI(Init,) = 0;
+
+/* State info for instance of Viterbi decoder */
+struct VITERBI(vd,) {
+  unsigned int metrics1[VNUMSTATES]; /* path metric buffer 1 */
+  unsigned int metrics2[VNUMSTATES]; /* path metric buffer 2 */
+  unsigned int *old_metrics,*new_metrics; /* Pointers to path metrics, swapped on every bit */
+  unsigned int *dp;          /* Pointer to current decision */
+  unsigned int *decisions;   /* Beginning of decisions for block [VDECWORDS per bit] */
+};
+
+
+/* Initialize Viterbi decoder for start of new frame */
+int VITERBI(init_viterbi,)(void *p, int starting_state)
+{
+	struct VITERBI(vd,) *vp = p;
+
+	if(p == NULL)
+		return -1;
+
+	for(int i = 0; i < VNUMSTATES; i++)
+		vp->metrics1[i] = 63;
+
+	vp->old_metrics = vp->metrics1;
+	vp->new_metrics = vp->metrics2;
+	vp->dp = vp->decisions;
+	vp->old_metrics[starting_state & (VNUMSTATES-1)] = 0; /* Bias known start state */
+
+	return 0;
+}
+
+void VITERBI(set_viterbi,_polynomial)(int polys[VITERBI_RATE])
+{
+	for(int state = 0; state < (VNUMSTATES/2); state++)
+	{
+		for (int i=0; i<VITERBI_RATE; i++)
+		{
+			VITERBI(Branchtab,)[i][state] = (polys[i] < 0) ^ parity((2*state) & abs(polys[i])) ? 255 : 0;
+		}
+	}
+
+	VITERBI(Init,)++;
+}
+
+/* Create a new instance of a Viterbi decoder */
+void *VITERBI(create_viterbi,)(int len)
+{
+	struct VITERBI(vd,) *vp;
+
+	if(!VITERBI(Init,))
+		VITERBI(set_viterbi,_polynomial)(VITERBI(polys,));
+
+	if((vp = malloc(sizeof(struct VITERBI(vd,)))) == NULL)
+		return NULL;
+
+	if((vp->decisions = malloc((len+(VITERBI_K-1))*VDECWORDS*sizeof(unsigned int))) == NULL){
+		free(vp);
+		return NULL;
+	}
+	VITERBI(init_viterbi,)(vp,0);
+
+	return vp;
+}
+
+/* Viterbi chainback */
+int VITERBI(chainback_viterbi,)(void *p, unsigned char *data, /* Decoded output data */ unsigned int nbits, /* Number of data bits */ unsigned int endstate) /* Terminal encoder state */
+{
+	struct VITERBI(vd,) *vp = p;
+
+	if(p == NULL)
+		return -1;
+
+	const unsigned int *d = vp->decisions;
+
+	/* ADDSHIFT and SUBSHIFT make sure that the thing returned is a byte. */
+	const unsigned int addshift = (VITERBI_K-1 < 8) ? (8-(VITERBI_K-1)) : 0;
+	const unsigned int subshift = (VITERBI_K-1 > 8) ? ((VITERBI_K-1)-8) : 0;
+
+	endstate = (endstate % VNUMSTATES) << addshift;
+
+	d += (VITERBI_K-1)*VDECWORDS; /* Look past tail */
+	while (nbits-- != 0)
+	{
+		unsigned int s = endstate >> addshift;
+		int k = (d[nbits*VDECWORDS + s/32] >> (s%32)) & 1;
+		endstate = (endstate >> 1) | (k << (VITERBI_K-2+addshift));
+		data[nbits >> 3] = endstate >> subshift;
+	}
+
+	return 0;
+}
+
+/* Delete instance of a Viterbi decoder */
+void VITERBI(delete_viterbi,)(void *p)
+{
+	struct VITERBI(vd,) *vp = p;
+
+	if(vp != NULL){
+	free(vp->decisions);
+	free(vp);
+	}
+}
+
+/* Update decoder with a block of demodulated symbols (VITERBI_RATE per bit)
+ * Note that nbits is the number of decoded data bits, not the number
+ * of symbols!
+ */
+int VITERBI(update_viterbi,_blk)(void *p, unsigned char syms[], int nbits)
+{
+	struct VITERBI(vd,) *vp = p;
+
+	if(p == NULL)
+		return -1;
+
+	unsigned int *d = vp->dp;
+
+	while(nbits--){
+		const unsigned int *old_metrics = vp->old_metrics;
+		unsigned int *new_metrics = vp->new_metrics;
+		unsigned int sym[VITERBI_RATE];
+		unsigned int dw[VDECWORDS] = { 0 };
+
+		for (int r = 0; r < VITERBI_RATE; r++)
+			sym[r] = syms[r];
+
+		/* C-language butterfly */
+		#pragma GCC unroll 128
+		for(int i = 0; i < (VNUMSTATES/2); i++){
+			unsigned int metric = 0, m0, m1, decision;
+
+			#pragma GCC unroll 8
+			for (int r = 0; r < VITERBI_RATE; r++)
+				metric += VITERBI(Branchtab,)[r][i] ^ sym[r];
+
+			m0 = old_metrics[i] + metric;
+			m1 = old_metrics[i+(VNUMSTATES/2)] + (VMAXMETRIC - metric);
+			decision = (signed int)(m0-m1) > 0;
+			new_metrics[2*i] = decision ? m1 : m0;
+			dw[(2*i)/32] |= decision << ((2*i)&31);
+			m0 -= (metric+metric-VMAXMETRIC);
+			m1 += (metric+metric-VMAXMETRIC);
+			decision = (signed int)(m0-m1) > 0;
+			new_metrics[2*i+1] = decision ? m1 : m0;
+			dw[(2*i+1)/32] |= decision << ((2*i+1)&31);
+		}
+
+		for (int w = 0; w < VDECWORDS; w++)
+			d[w] = dw[w];
+
+		syms += VITERBI_RATE;
+		d += VDECWORDS;
+
+		/* Swap pointers to old and new metrics */
+		vp->old_metrics = new_metrics;
+		vp->new_metrics = (unsigned int *)old_metrics;
+	}
+
+	vp->dp = d;
+
+	return 0;
+}
+
+/* Encode nbits of data (MSB first) and K-1 tail bits into VITERBI_RATE symbols (0 or 255) per bit,
+ * ready for update_viterbi_blk.
+ */
+void VITERBI(encode_viterbi,)(unsigned char *syms, unsigned char *data, unsigned int nbits)
+{
+	unsigned int sr = 0;
+
+	for (unsigned int i = 0; i < nbits + VITERBI_K-1; i++)
+	{
+		unsigned int bit = i < nbits ? (data[i >> 3] >> (7 - (i & 7))) & 1 : 0;
+		sr = (sr << 1) | bit;
+
+		#pragma GCC unroll 8
+		for (int r = 0; r < VITERBI_RATE; r++)
+			*syms++ = parity(sr & VITERBI(polys,)[r]) ? 255 : 0;
+	}
+}
+
+#undef VNUMSTATES
+#undef VMAXMETRIC
+#undef VDECWORDS
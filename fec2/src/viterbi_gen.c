@@ -0,0 +1,68 @@
+/*
+ * Specialized Viterbi decoders and encoders generated from viterbi.proto.c.
+ *
+ * Add a code by defining its name, constraint length, rate and polynomials, then including the prototype.
+ * Matching prototypes go in fec2.h.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fec2.h"
+
+
+unsigned char Partab[256];
+int P_init;
+
+/* Create 256-entry odd-parity lookup table
+ * Needed only on non-ia32 machines
+ */
+void partab_init(void){
+  int i,cnt,ti;
+
+  /* Initialize parity lookup table */
+  for(i=0;i<256;i++){
+    cnt = 0;
+    ti = i;
+    while(ti){
+      if(ti & 1)
+	cnt++;
+      ti >>= 1;
+    }
+    Partab[i] = cnt & 1;
+  }
+  P_init=1;
+}
+
+
+// r=1/2 K=5 (M17)
+#define VITERBI(pre,post)   pre##25##post
+#define VITERBI_K           5
+#define VITERBI_RATE        2
+#define VITERBI_POLYS       { V25POLYA, V25POLYB }
+#include "viterbi.proto.c"
+#undef VITERBI
+#undef VITERBI_K
+#undef VITERBI_RATE
+#undef VITERBI_POLYS
+
+// r=1/2 K=7 (CCSDS / NASA standard)
+#define VITERBI(pre,post)   pre##27##post
+#define VITERBI_K           7
+#define VITERBI_RATE        2
+#define VITERBI_POLYS       { V27POLYA, V27POLYB }
+#include "viterbi.proto.c"
+#undef VITERBI
+#undef VITERBI_K
+#undef VITERBI_RATE
+#undef VITERBI_POLYS
+
+// r=1/3 K=7
+#define VITERBI(pre,post)   pre##37##post
+#define VITERBI_K           7
+#define VITERBI_RATE        3
+#define VITERBI_POLYS       { V37POLYA, V37POLYB, V37POLYC }
+#include "viterbi.proto.c"
+#undef VITERBI
+#undef VITERBI_K
+#undef VITERBI_RATE
+#undef VITERBI_POLYS
@@ -0,0 +1,651 @@
+//
+// M17 RX Simulator.
+//
+// Finds M17 Frames in a capture (bit stream) or demodulated baseband written by the TX Simulator, decodes and checks them.
+//
+// M17 Packets are printed in the terminal. 
+//
+
+// Kernal Headers
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+// M17 Headers
+#include "fec2.h"
+#include "crypt2.h"
+#include "modem2.h"
+#include "codec2/src/HRA_112_112.h"
+
+
+
+// Capture Input
+#define CAPTURE_FILE "m17_capture.bin"
+#define SYNC_MAX_ERRORS 2 // Bit errors tolerated in a Sync Burst.
+
+// Baseband Input
+#define BASEBAND_INPUT 1 // Demodulate BASEBAND_FILE (4FSK, 48000Hz, 16bit MONO) instead of reading CAPTURE_FILE.
+#define BASEBAND_FILE "m17_baseband.raw"
+#define BASEBAND_SCALE 7000.0f // Sample value of +1 symbol, see TX Simulator.
+#define BASEBAND_BLOCK 4800 // Samples demodulated per call (100ms).
+
+// Packet Output
+#define PACKET_FILE "m17_packet_rx.bin" // Payload of every Packet with a valid CRC.
+#define PACKET_LDPC 0 // Packet Frames are encoded with the codec2 HRA_112_112 LDPC code. See TX Simulator.
+#define PACKET_LDPC_MAX_ITER 50 // Iteration limit per codeword.
+#define PACKET_LDPC_LLR_SHIFT 2 // Scales demodulator LLRs (upto +/-127) to the +/-8 to +/-32 the LDPC decoder expects.
+#define PACKET_LDPC_HARD_LLR 16 // LLR of a hard bit from CAPTURE_FILE.
+
+
+// M17 Sync Burst
+const uint16_t m17_syncs[3] = { 0x3243, 0x3423, 0x75FF };   // Link Setup Frame, Sub Frame, Packet Frame. !! OUT OF SPEC !! See TX Simulator.
+
+#define M17_SYNC_SETUP_FRAME 0
+#define M17_SYNC_SUB_FRAME 1
+#define M17_SYNC_PACKET_FRAME 2
+
+// M17 Stream Mode
+#define M17_TYPE_STREAM 0x8000 // Packet/Stream bit of the Type, set for Stream Mode. See TX Simulator.
+#define M17_FN_EOS 0x8000 // End of Stream bit of the Frame Number.
+#define M17_FN_MAX_LOST 4 // Sub Frames that may be lost before a Frame Number jump is taken as a new Stream.
+
+// M17 Packet Mode - See TX Simulator.
+#define M17_PACKET_CHUNK_LEN 24
+#define M17_PACKET_FRAME_LEN 25
+#define M17_PACKET_MAX_FRAMES 32
+#define M17_PACKET_EOF 0x80
+
+// M17 Packet Mode LDPC - HRA_112_112 codewords run on across Packet Frames. See TX Simulator.
+#define M17_LDPC_DEC_LEN (HRA_112_112_NUMBERROWSHCOLS/8)   // 14 Bytes
+#define M17_LDPC_ENC_BITS HRA_112_112_CODELENGTH            // 224 Bits
+
+
+/*****
+
+M17 Receiver State
+
+*****/
+
+struct m17_rx {
+    fec lich_fec;                   // Setup Frame - Viterbi R=1/2 K=5 Punctured 45/60
+    interleaver lich_il;
+    unsigned int lich_enc_len;
+
+    fec sub_frame_fec;              // Sub Frame - Viterbi R=1/2 K=5 Punctured 33/40
+    interleaver sub_frame_il;
+    unsigned int sub_frame_enc_len;
+
+    lich_assembler lich_asm;        // Late entry - LICH from Sub Frame LICH Chunks
+    int have_lich;
+    int in_stream;                  // Stream started and not ended, next_fn is valid.
+    unsigned int next_fn;           // Frame Number expected next in the Stream.
+
+    fec packet_fec;                 // Packet Frame - Viterbi R=1/2 K=5 Punctured 7/8
+    interleaver packet_il;
+    unsigned int packet_enc_len;
+
+    ldpc packet_ldpc;               // Packet Frame - LDPC HRA_112_112 if PACKET_LDPC, else NULL.
+    signed char packet_ldpc_llr[M17_LDPC_ENC_BITS + 8*RANDOMIZER_LEN]; // LLRs of codewords not yet decoded.
+    unsigned int packet_ldpc_llr_len;
+    unsigned char packet_ldpc_data[M17_PACKET_FRAME_LEN + M17_LDPC_DEC_LEN]; // Decoded Bytes not yet a full chunk.
+    unsigned int packet_ldpc_data_len;
+    unsigned long packet_ldpc_next; // Bit offset of the Packet Frame that continues the codewords.
+    int packet_ldpc_sync;           // In step with the Packets, the next chunk is where the codewords put it.
+
+    unsigned char packet[M17_PACKET_MAX_FRAMES*M17_PACKET_CHUNK_LEN]; // Packet being received.
+    unsigned int packet_frames;     // Frames received, next expected Frame Counter.
+    int packet_lost;                // Frame missing from current Packet.
+    FILE *packet_fptr;
+
+    unsigned long packets;
+    unsigned long packet_errors;
+
+    unsigned long frames;
+    unsigned long crc_errors;
+
+    signed char *llr;               // Baseband input - LLR per bit searched by the Frame Synchronizer, NULL for CAPTURE_FILE.
+};
+
+
+/*****
+
+Internal Funtions
+
+*****/
+
+/* 
+ * Decodes 6 character Base40 callsign and returns 9 character Callsign.
+ * 
+ * _enc_callsign   :   encoded callsign (6 Bytes)
+ * _dec_callsign   :   decoded callsign (10 Bytes, null terminated)
+ */
+void base40_callsign_decode(unsigned char *_enc_callsign, char *_dec_callsign)
+{
+    uint64_t decoded_base40 = 0;
+
+    for (int i = 0; i < 6; ++i)
+    {
+        decoded_base40 += (((uint64_t) _enc_callsign[i] & 0xFF) << (40 - (8*i)));
+    }
+
+    char *p = _dec_callsign;
+
+    if (decoded_base40 < 262144000000000) // Larger than or equal to 40^9 is not a callsign.
+    {
+        for (; decoded_base40 > 0; p++) {
+            *p = "xABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-/."[decoded_base40 % 40];
+            decoded_base40 /= 40;
+        }
+    }
+
+    *p = 0;
+}
+
+//DEBUG - Prints array as 1 Byte HEX
+void print_char_hex(unsigned char *_in, int _len)
+{
+	for (int i = 0; i<_len; i++)
+	{
+	    printf("%02X", _in[i] & 0xFF);
+
+	    if (i < (_len - 1)) printf("-");
+	}
+}
+
+
+void m17_print_lich(unsigned char *_lich)
+{
+    char dst[10], src[10];
+    base40_callsign_decode(_lich, dst);
+    base40_callsign_decode(_lich + 6, src);
+
+    printf("DST: %-9s SRC: %-9s Type: %02X%02X Nonce: ", dst, src, _lich[12], _lich[13]);
+    print_char_hex(_lich + 14, 14);
+}
+
+void m17_receive_setup_frame(struct m17_rx *_rx, unsigned char *_payload, signed char *_llr)
+{
+    unsigned char lich[30];
+
+    // De-interleave and Decode LICH, soft decisions if there are LLRs.
+    if (_llr != NULL)
+    {
+        signed char deinterleaved_lich[8*_rx->lich_enc_len];
+        interleaver_decode_soft(_rx->lich_il, (unsigned char*)_llr, (unsigned char*)deinterleaved_lich);
+        convolutional_punctured_decode_soft(_rx->lich_fec, sizeof(lich), deinterleaved_lich, lich);
+    }
+    else
+    {
+        unsigned char deinterleaved_lich[_rx->lich_enc_len];
+        interleaver_decode(_rx->lich_il, _payload, deinterleaved_lich);
+        convolutional_punctured_decode(_rx->lich_fec, sizeof(lich), deinterleaved_lich, lich);
+    }
+
+    // Check CRC
+    uint16_t crc = crc16_m17(lich, 28);
+    int crc_ok = (lich[28] == ((crc >> 8) & 0xFF)) && (lich[29] == (crc & 0xFF));
+
+    if (!crc_ok) _rx->crc_errors++;
+
+    // New Stream. Late entry is only needed if the Setup Frame is lost.
+    lich_assembler_reset(_rx->lich_asm);
+    _rx->have_lich = crc_ok;
+    _rx->in_stream = crc_ok && (((lich[12] << 8) | lich[13]) & M17_TYPE_STREAM);
+    _rx->next_fn = 0;
+
+    printf("Setup Frame:    ");
+    m17_print_lich(lich);
+    printf(" CRC %s\n", crc_ok ? "OK" : "ERROR");
+}
+
+void m17_receive_sub_frame(struct m17_rx *_rx, unsigned char *_payload, signed char *_llr)
+{
+    unsigned char lich_chunk[6];
+    unsigned char sub_frame_chunk[20];
+
+    // Decode LICH Chunk
+    fec_golay2412_decode(sizeof(lich_chunk), _payload, lich_chunk);
+
+    // De-interleave and Decode Frame Number, Payload and CRC, soft decisions if there are LLRs.
+    if (_llr != NULL)
+    {
+        signed char deinterleaved_sub_frame_chunk[8*_rx->sub_frame_enc_len];
+        interleaver_decode_soft(_rx->sub_frame_il, (unsigned char*)(_llr + LICH_CHUNK_ENC_BITS), (unsigned char*)deinterleaved_sub_frame_chunk);
+        convolutional_punctured_decode_soft(_rx->sub_frame_fec, sizeof(sub_frame_chunk), deinterleaved_sub_frame_chunk, sub_frame_chunk);
+    }
+    else
+    {
+        unsigned char deinterleaved_sub_frame_chunk[_rx->sub_frame_enc_len];
+        interleaver_decode(_rx->sub_frame_il, _payload + LICH_CHUNK_ENC_LEN, deinterleaved_sub_frame_chunk);
+        convolutional_punctured_decode(_rx->sub_frame_fec, sizeof(sub_frame_chunk), deinterleaved_sub_frame_chunk, sub_frame_chunk);
+    }
+
+    // Check CRC over LICH Chunk, Frame Number and Payload
+    unsigned char crc_sub_frame_chunk[24];
+    memcpy(crc_sub_frame_chunk, lich_chunk, 6);
+    memcpy(crc_sub_frame_chunk + 6, sub_frame_chunk, 18);
+
+    uint16_t crc = crc16_m17(crc_sub_frame_chunk, 24);
+    int crc_ok = (sub_frame_chunk[18] == ((crc >> 8) & 0xFF)) && (sub_frame_chunk[19] == (crc & 0xFF));
+
+    if (!crc_ok) _rx->crc_errors++;
+
+    uint16_t fn = (sub_frame_chunk[0] << 8) | sub_frame_chunk[1];
+
+    printf("Sub Frame (%02d): LICH: ", fn);
+    print_char_hex(lich_chunk, 6);
+    printf(" Payload: ");
+    print_char_hex(sub_frame_chunk + 2, 16);
+    printf(" CRC %s\n", crc_ok ? "OK" : "ERROR");
+
+    // Frame Number, and with it the LICH Chunk index, is only known if the CRC is OK.
+    if (!crc_ok)
+        return;
+
+    // New Stream without a Setup Frame - the last Stream ended or the Frame Number jumped. Restart late entry.
+    if (!_rx->in_stream || ((fn - _rx->next_fn) & 0x7FFF) > M17_FN_MAX_LOST)
+    {
+        lich_assembler_reset(_rx->lich_asm);
+        _rx->have_lich = 0;
+    }
+
+    _rx->in_stream = !(fn & M17_FN_EOS);
+    _rx->next_fn = (fn + 1) & 0x7FFF;
+
+    // Late entry - Combine encoded LICH Chunks until the LICH is valid.
+    int lich_valid = 0;
+
+    if (!_rx->have_lich)
+        lich_valid = (_llr != NULL) ? lich_assembler_add_soft(_rx->lich_asm, (fn & 0x7FFF) % LICH_CHUNKS, _llr)
+                                    : lich_assembler_add(_rx->lich_asm, (fn & 0x7FFF) % LICH_CHUNKS, _payload);
+
+    if (lich_valid)
+    {
+        unsigned char lich[LICH_LEN];
+        lich_assembler_get(_rx->lich_asm, lich);
+        _rx->have_lich = 1;
+
+        printf("Late Entry:     ");
+        m17_print_lich(lich);
+        printf("\n");
+    }
+}
+
+// Adds a decoded chunk and Control byte to the Packet being received. Returns 1 for the last chunk (EOF).
+int m17_receive_packet_chunk(struct m17_rx *_rx, unsigned char *_chunk)
+{
+    unsigned char control = _chunk[M17_PACKET_CHUNK_LEN];
+    unsigned int counter = (control >> 2) & 0x1F;
+
+    printf("Packet Frame (%02d): ", control & M17_PACKET_EOF ? _rx->packet_frames : counter);
+    print_char_hex(_chunk, M17_PACKET_CHUNK_LEN);
+    printf("%s\n", control & M17_PACKET_EOF ? " EOF" : "");
+
+    if (!(control & M17_PACKET_EOF))
+    {
+        // Start of a new Packet, or a Frame was lost.
+        if (counter == 0)
+        {
+            _rx->packet_frames = 0;
+            _rx->packet_lost = 0;
+        }
+        else if (counter != _rx->packet_frames)
+            _rx->packet_lost = 1;
+
+        if (counter < M17_PACKET_MAX_FRAMES - 1)
+            memcpy(_rx->packet + counter*M17_PACKET_CHUNK_LEN, _chunk, M17_PACKET_CHUNK_LEN);
+
+        _rx->packet_frames = counter + 1;
+        return 0;
+    }
+
+    // Last Frame - Counter holds number of bytes in chunk.
+    unsigned int packet_len = _rx->packet_frames*M17_PACKET_CHUNK_LEN + counter;
+    int packet_ok = 0;
+
+    if (!_rx->packet_lost && counter <= M17_PACKET_CHUNK_LEN && packet_len >= 2 && _rx->packet_frames < M17_PACKET_MAX_FRAMES)
+    {
+        memcpy(_rx->packet + _rx->packet_frames*M17_PACKET_CHUNK_LEN, _chunk, counter);
+
+        // Check CRC over Payload
+        uint16_t crc = crc16_m17(_rx->packet, packet_len - 2);
+        packet_ok = (_rx->packet[packet_len - 2] == ((crc >> 8) & 0xFF)) && (_rx->packet[packet_len - 1] == (crc & 0xFF));
+    }
+
+    if (packet_ok)
+        fwrite(_rx->packet, sizeof(unsigned char), packet_len - 2, _rx->packet_fptr);
+    else
+        _rx->packet_errors++;
+
+    printf("Packet:         %u Bytes CRC %s\n", packet_len - 2, packet_ok ? "OK" : "ERROR");
+
+    _rx->packets++;
+    _rx->packet_frames = 0;
+    _rx->packet_lost = 0;
+
+    return 1;
+}
+
+void m17_receive_packet_frame(struct m17_rx *_rx, unsigned char *_payload, signed char *_llr)
+{
+    unsigned char packet_chunk[M17_PACKET_FRAME_LEN];
+
+    // De-interleave and Decode Chunk and Control byte, soft decisions if there are LLRs.
+    if (_llr != NULL)
+    {
+        signed char deinterleaved_packet_chunk[8*_rx->packet_enc_len];
+        interleaver_decode_soft(_rx->packet_il, (unsigned char*)_llr, (unsigned char*)deinterleaved_packet_chunk);
+        convolutional_punctured_decode_soft(_rx->packet_fec, sizeof(packet_chunk), deinterleaved_packet_chunk, packet_chunk);
+    }
+    else
+    {
+        unsigned char deinterleaved_packet_chunk[_rx->packet_enc_len];
+        interleaver_decode(_rx->packet_il, _payload, deinterleaved_packet_chunk);
+        convolutional_punctured_decode(_rx->packet_fec, sizeof(packet_chunk), deinterleaved_packet_chunk, packet_chunk);
+    }
+
+    m17_receive_packet_chunk(_rx, packet_chunk);
+}
+
+// LDPC Packet in progress can not be completed, its Frames are out of step.
+void m17_packet_ldpc_lost(struct m17_rx *_rx)
+{
+    if (_rx->packet_ldpc_sync && (_rx->packet_frames > 0 || _rx->packet_ldpc_data_len > 0 || _rx->packet_ldpc_llr_len > 0))
+    {
+        printf("Packet:         lost\n");
+
+        _rx->packets++;
+        _rx->packet_errors++;
+        _rx->packet_frames = 0;
+        _rx->packet_lost = 0;
+    }
+
+    _rx->packet_ldpc_sync = 0;
+}
+
+/* 
+ * Receives an LDPC encoded Packet Frame. !! OUT OF SPEC !! See TX Simulator.
+ * 
+ * Codewords run on across the Frames of a Packet, and every Packet starts with a new Frame. Codewords are
+ * decoded as they complete. After a lost Frame or a codeword that fails its checks, the receiver is out of
+ * step and waits for a Frame whose first chunk starts a Packet (Counter 0, or the last chunk).
+ */
+void m17_receive_packet_frame_ldpc(struct m17_rx *_rx, unsigned char *_payload, signed char *_llr, unsigned long _bit_offset)
+{
+    // Frame does not follow on from the last one.
+    if (_bit_offset != _rx->packet_ldpc_next)
+    {
+        m17_packet_ldpc_lost(_rx);
+        _rx->packet_ldpc_llr_len = 0;
+        _rx->packet_ldpc_data_len = 0;
+    }
+
+    _rx->packet_ldpc_next = _bit_offset + 8*(2 + RANDOMIZER_LEN);
+
+    // Append LLRs of the Frame, hard bits are taken as +/-PACKET_LDPC_HARD_LLR.
+    unsigned int frame_start = _rx->packet_ldpc_llr_len;
+    signed char *llr = _rx->packet_ldpc_llr + frame_start;
+
+    for (int i = 0; i < 8*RANDOMIZER_LEN; i++)
+    {
+        if (_llr != NULL)
+            llr[i] = _llr[i] >> PACKET_LDPC_LLR_SHIFT;
+        else
+            llr[i] = ((_payload[i >> 3] << (i & 7)) & 0x80) ? PACKET_LDPC_HARD_LLR : -PACKET_LDPC_HARD_LLR;
+    }
+
+    _rx->packet_ldpc_llr_len += 8*RANDOMIZER_LEN;
+
+    // Decode complete codewords one at a time, the rest of the Frame after the last chunk is padding.
+    unsigned int n = 0;
+
+    while (_rx->packet_ldpc_llr_len - n >= M17_LDPC_ENC_BITS)
+    {
+        unsigned int codeword_start = n;
+        int valid = ldpc_decode_soft(_rx->packet_ldpc, 1, _rx->packet_ldpc_llr + n,
+                                     _rx->packet_ldpc_data + _rx->packet_ldpc_data_len, PACKET_LDPC_MAX_ITER);
+        n += M17_LDPC_ENC_BITS;
+        _rx->packet_ldpc_data_len += M17_LDPC_DEC_LEN;
+
+        int eof = 0;
+
+        while (valid && !eof && _rx->packet_ldpc_data_len >= M17_PACKET_FRAME_LEN)
+        {
+            if (!_rx->packet_ldpc_sync)
+            {
+                unsigned char control = _rx->packet_ldpc_data[M17_PACKET_CHUNK_LEN];
+                unsigned int counter = (control >> 2) & 0x1F;
+
+                if ((control & M17_PACKET_EOF) ? counter > M17_PACKET_CHUNK_LEN : counter != 0)
+                {
+                    valid = 0;
+                    break;
+                }
+
+                _rx->packet_ldpc_sync = 1;
+            }
+
+            eof = m17_receive_packet_chunk(_rx, _rx->packet_ldpc_data);
+
+            _rx->packet_ldpc_data_len -= M17_PACKET_FRAME_LEN;
+            memmove(_rx->packet_ldpc_data, _rx->packet_ldpc_data + M17_PACKET_FRAME_LEN, _rx->packet_ldpc_data_len);
+        }
+
+        if (!valid)
+        {
+            // Try this Frame as the start of a Packet, unless it already was.
+            m17_packet_ldpc_lost(_rx);
+            _rx->packet_ldpc_data_len = 0;
+            n = codeword_start < frame_start ? frame_start : _rx->packet_ldpc_llr_len;
+        }
+        else if (eof)
+        {
+            _rx->packet_ldpc_data_len = 0;
+            n = _rx->packet_ldpc_llr_len;
+        }
+    }
+
+    _rx->packet_ldpc_llr_len -= n;
+    memmove(_rx->packet_ldpc_llr, _rx->packet_ldpc_llr + n, _rx->packet_ldpc_llr_len);
+}
+
+
+// Called by the Frame Synchronizer for each frame found in the capture.
+void m17_receive_frame(unsigned char *_frame, unsigned int _sync, unsigned long _bit_offset, void *_userdata)
+{
+    struct m17_rx *rx = _userdata;
+    unsigned char payload[RANDOMIZER_LEN];
+    signed char payload_llr[8*RANDOMIZER_LEN];
+    signed char *llr = NULL;
+
+    // De-randomize Type 4 Payload
+    randomizer_encode(0, RANDOMIZER_LEN, _frame + 2, RANDOMIZER_LEN, payload);
+
+    // Baseband input - De-randomize LLRs of the Payload following the Sync Burst, a randomizer 1 flips the sign.
+    if (rx->llr != NULL)
+    {
+        const signed char *in = rx->llr + _bit_offset + 16;
+
+        for (int i = 0; i < 8*RANDOMIZER_LEN; i++)
+            payload_llr[i] = ((randomizer_seq[i >> 3] << (i & 7)) & 0x80) ? -in[i] : in[i];
+
+        llr = payload_llr;
+    }
+
+    if (_sync == M17_SYNC_SETUP_FRAME)
+        m17_receive_setup_frame(rx, payload, llr);
+    else if (_sync == M17_SYNC_SUB_FRAME)
+        m17_receive_sub_frame(rx, payload, llr);
+    else if (rx->packet_ldpc != NULL)
+        m17_receive_packet_frame_ldpc(rx, payload, llr, _bit_offset);
+    else
+        m17_receive_packet_frame(rx, payload, llr);
+
+    rx->frames++;
+}
+
+
+/* 
+ * Demodulates a baseband file.
+ * 
+ * _path           :   baseband file (48000Hz, 16bit MONO)
+ * _llr            :   LLR per bit, > 0 favours 1. Allocated here, freed by the caller.
+ * 
+ * Returns number of LLRs (2 per symbol), -1 if the file could not be read.
+ */
+long m17_demodulate_file(const char *_path, signed char **_llr)
+{
+    FILE *fptr;
+
+    if ( (fptr = fopen(_path, "rb")) == NULL )
+        return -1;
+
+    fseek(fptr, 0, SEEK_END);
+    long len = ftell(fptr) / sizeof(short);
+    fseek(fptr, 0, SEEK_SET);
+
+    if (len < 0) {
+        fclose(fptr);
+        return -1;
+    }
+
+    // Each call writes at most 2*(n/M17_SPS + 1) LLRs. One more call flushes the matched filter.
+    long num_blocks = (len + BASEBAND_BLOCK - 1) / BASEBAND_BLOCK + 1;
+    signed char *llr = (signed char*) malloc(2 * (len / M17_SPS + (RRC_DELAY + 1) + num_blocks));
+
+    if (llr == NULL) {
+        fclose(fptr);
+        return -1;
+    }
+
+    demodulator demod = demodulator_create();
+    short baseband[BASEBAND_BLOCK];
+    float samples[BASEBAND_BLOCK];
+    long num_llr = 0;
+    size_t n;
+
+    while ( (n = fread(baseband, sizeof(short), BASEBAND_BLOCK, fptr)) > 0 )
+    {
+        for (size_t i = 0; i < n; i++)
+            samples[i] = baseband[i] / BASEBAND_SCALE;
+
+        num_llr += demodulator_execute(demod, samples, n, llr + num_llr);
+    }
+
+    // The last symbols are still in the matched filter, push zeros to strobe them.
+    memset(samples, 0, (RRC_DELAY + 1) * M17_SPS * sizeof(float));
+    num_llr += demodulator_execute(demod, samples, (RRC_DELAY + 1) * M17_SPS, llr + num_llr);
+
+    demodulator_destroy(demod);
+    fclose(fptr);
+
+    *_llr = llr;
+
+    return num_llr;
+}
+
+// Packs hard decisions (LLR > 0 is 1) most significant bit first. _bits [size: 1 x (_n + 7)/8]
+void m17_hard_decide(signed char *_llr, unsigned long _n, unsigned char *_bits)
+{
+    memset(_bits, 0, (_n + 7) / 8);
+
+    for (unsigned long i = 0; i < _n; i++)
+        if (_llr[i] > 0)
+            _bits[i >> 3] |= 0x80 >> (i & 7);
+}
+
+
+int main (void) {
+
+	printf ("Program Started.\n");
+
+    struct m17_rx rx;
+    memset(&rx, 0, sizeof(rx));
+
+    // Create fec and interleaver objects once, reused for every frame.
+    rx.lich_fec = convolutional_punctured_create(CONV_25_P45_60);
+    rx.lich_enc_len = get_convolutional_msg_len(rx.lich_fec, 30);
+    rx.lich_il = interleaver_create(rx.lich_enc_len);
+
+    rx.sub_frame_fec = convolutional_punctured_create(CONV_25_P33_40);
+    rx.sub_frame_enc_len = get_convolutional_msg_len(rx.sub_frame_fec, 20);
+    rx.sub_frame_il = interleaver_create(rx.sub_frame_enc_len);
+
+    rx.packet_fec = convolutional_punctured_create(CONV_25_P7_8);
+    rx.packet_enc_len = get_convolutional_msg_len(rx.packet_fec, M17_PACKET_FRAME_LEN);
+    rx.packet_il = interleaver_create(rx.packet_enc_len);
+
+#if PACKET_LDPC
+    if ( (rx.packet_ldpc = ldpc_create(LDPC_CODE(HRA_112_112))) == NULL ) {
+
+        printf("Error creating LDPC decoder.\n");
+        exit(1);
+    }
+#endif
+
+    rx.lich_asm = lich_assembler_create();
+
+    if ( (rx.packet_fptr = fopen(PACKET_FILE,"wb")) == NULL ) {
+
+        printf("Error opening packet file.\n");
+        exit(1);
+    }
+
+    // Find and decode Frames
+    framesync fs = framesync_create(m17_syncs, 3, SYNC_MAX_ERRORS);
+
+#if BASEBAND_INPUT
+    // Demodulate, search the hard decisions for Frames and decode them from the LLRs.
+    signed char *llr;
+    long num_llr = m17_demodulate_file(BASEBAND_FILE, &llr);
+
+    if (num_llr < 0) {
+
+        printf("Error opening baseband file.\n");
+        exit(1);
+    }
+
+    unsigned char *bits = (unsigned char*) malloc((num_llr + 7) / 8 + 1);
+
+    if (bits == NULL) {
+
+        printf("Error allocating baseband buffers.\n");
+        exit(1);
+    }
+
+    m17_hard_decide(llr, num_llr, bits);
+
+    rx.llr = llr;
+    framesync_execute(fs, bits, num_llr / 8, m17_receive_frame, &rx);
+    rx.llr = NULL;
+
+    free(bits);
+    free(llr);
+#else
+    if (framesync_file(fs, CAPTURE_FILE, m17_receive_frame, &rx) < 0) {
+
+        printf("Error opening capture file.\n");
+        exit(1);
+    }
+#endif
+
+    printf("Frames: %lu CRC Errors: %lu\n", rx.frames, rx.crc_errors);
+    printf("Packets: %lu Packet Errors: %lu\n", rx.packets, rx.packet_errors);
+
+    // Clean up
+    framesync_destroy(fs);
+    convolutional_punctured_destroy(rx.lich_fec);
+    convolutional_punctured_destroy(rx.sub_frame_fec);
+    interleaver_destroy(rx.lich_il);
+    interleaver_destroy(rx.sub_frame_il);
+    convolutional_punctured_destroy(rx.packet_fec);
+    interleaver_destroy(rx.packet_il);
+    if (rx.packet_ldpc != NULL)
+        ldpc_destroy(rx.packet_ldpc);
+    lich_assembler_destroy(rx.lich_asm);
+    fclose(rx.packet_fptr);
+
+	printf ("Program Finished.\n");
+}
@@ -17,18 +17,39 @@
 
 // M17 Headers
 #include "codec2/src/codec2.h"
+#include "codec2/src/HRA_112_112.h"
 #include "fec2.h"
 #include "crypt2.h"
+#include "modem2.h"
 
 
 
 // Debug
 #define SIMULATE_REALTIME 0 // Add realtime delay to after the "Capture" of audio.
 
+// Offline Encoding
+#define OFFLINE_ENCODE_THREADS 0 // If non-zero, encode the whole audio file first split over this many threads.
+#define OFFLINE_ENCODE_REPORT 0 // Report bit differences of the offline encode versus a sequential encode. Encodes the file twice.
+
 #define DEBUG_SETUP_FRAME 0
 #define DEBUG_SUB_FRAME 0
 
 
+// Baseband Output
+#define BASEBAND_OUTPUT 1 // Write 4FSK baseband (48000Hz, 16bit MONO) of every frame to BASEBAND_FILE.
+#define BASEBAND_FILE "m17_baseband.raw"
+#define BASEBAND_SCALE 7000.0f // Sample value of +1 symbol. Leaves headroom for RRC overshoot on +/-3.
+
+// Capture Output
+#define CAPTURE_OUTPUT 1 // Write transmitted bit stream (Preamble and Frames) to CAPTURE_FILE. Read by m17_rx_simulator.
+#define CAPTURE_FILE "m17_capture.bin"
+
+// Packet Input
+#define PACKET_TRANSMIT 1 // Transmit PACKET_FILE in Packet Mode after the voice stream.
+#define PACKET_FILE "README.md"
+#define PACKET_LDPC 0 // Encode Packet Frames with the codec2 HRA_112_112 LDPC code instead of Viterbi. !! OUT OF SPEC !! RX Simulator must match.
+
+
 // M17 Type Definitions
 #define M17_PACKETMODE 0
 #define M17_STREAMMODE 1
@@ -42,6 +63,13 @@
 #define M17_SCRAMBLE_24 2
 #define M17_NONE 0
 
+// M17 Packet Mode - Packet (Payload and CRC) is split into 24 byte chunks. !! OUT OF SPEC !! Spec uses 25 bytes and 6 Control bits.
+#define M17_PACKET_CHUNK_LEN 24
+#define M17_PACKET_FRAME_LEN 25     // Chunk and Control byte (Type 1)
+#define M17_PACKET_MAX_FRAMES 32    // Limited by 5 bit Frame Counter.
+#define M17_PACKET_MAX_LEN (M17_PACKET_MAX_FRAMES*M17_PACKET_CHUNK_LEN - 2) // Payload without CRC (number of bytes)
+#define M17_PACKET_EOF 0x80         // Control byte - End of Frame flag. Bits 6-2 Frame Counter, or bytes in last chunk if EOF is set.
+
 
 struct m17_type_bf {
     unsigned int PacketStream:1;
@@ -54,6 +82,7 @@ struct m17_type_bf {
 // M17 Sync Burst
 const uint16_t m17_sync0 = 0x3243;
 const uint16_t m17_sync1 = 0x3423;  // !! OUT OF SPEC !! Used on subframes for idetification by the decoder.
+const uint16_t m17_sync2 = 0x75FF;  // Packet Frames.
 
 /*****
 
@@ -73,6 +102,17 @@ char *msg_dst = "GROUP01";
 int8_t aes_key[32] = { 0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
                        0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4 };
 
+// AES Key Store - Keys are expanded once when loaded and looked up by Key ID at call setup.
+aes_keystore aes_keys;
+
+// Key ID for current channel.
+// TODO - Get Key ID from "Current Channel" in Settings File.
+uint32_t aes_key_id = 1;
+
+// Scrambler Seed. Only the lower 8, 16 or 24 bits are used depending on Encryption Sub Type.
+// TODO - Get Scrambler Seed from "Current Channel" in Settings File.
+uint32_t scramble_key = 0x6A3C1F;
+
 // Per Call (transmission) Variables
 
 // Type
@@ -84,6 +124,11 @@ char m17_nonce[14];
 // Link Setup Frame (Link Information CHannel) - Contains Destination Address, Source Address, Type, NONCE. Tail not included in Serial transmission.
 unsigned char m17_lich[30] = "0";
 
+// 4FSK Modulator, Baseband and Capture Files.
+modulator m17_mod;
+FILE *baseband_fptr;
+FILE *capture_fptr;
+
 // Frame number - Starts from 0 and increments every frame. Used as a counter by CTR block cipher. Allows for a little over 43 minute transmissions.
 uint16_t m17_fn = 0;
 
@@ -212,6 +257,39 @@ void print_char_hex(char *_in, int _len)
 	}
 }
 
+// Append Frame to CAPTURE_FILE, modulate and append 16bit baseband samples to BASEBAND_FILE.
+void m17_output_frame(unsigned char *_frame, unsigned int _len)
+{
+#if CAPTURE_OUTPUT
+    fwrite(_frame, sizeof(unsigned char), _len, capture_fptr);
+#endif
+
+#if BASEBAND_OUTPUT
+    unsigned int n = modulator_get_samples_len(_len);
+    float samples[n];
+    short baseband[n];
+
+    modulator_execute(m17_mod, _frame, _len, samples);
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+        float v = samples[i] * BASEBAND_SCALE;
+        baseband[i] = v > 32767.0f ? 32767 : (v < -32768.0f ? -32768 : (short)v);
+    }
+
+    fwrite(baseband, sizeof(short), n, baseband_fptr);
+#endif
+}
+
+// "Transmit" Preamble. 40ms of alternating +3/-3 symbols ahead of the Setup Frame for receiver timing.
+void m17_transmit_preamble()
+{
+    unsigned char preamble[48];
+    memset(&preamble[0], 0x77, sizeof(preamble));
+
+    m17_output_frame(preamble, sizeof(preamble));
+}
+
 /* 
  * Decodes 6 character Base40 callsign and returns 9 character Callsign.
  * 
@@ -317,18 +395,19 @@ void m17_transmit_setup_frame()
 
     // Create Setup Frame
     unsigned char setup_frame[48];
-    memset(&setup_frame[0], 0, sizeof(setup_frame));
 
-    // Add SYNC and Type 4 Payload
+    // Add SYNC and Randomized Type 4 Payload (zero padded to 46 Bytes)
     setup_frame[0] = (uint64_t)((m17_sync0 >> 8) & 0xFF);
     setup_frame[1] = (uint64_t)((m17_sync0) & 0xFF);
-    memcpy(setup_frame + 2, interleaved_lich, n_enc);
+    randomizer_encode(0, RANDOMIZER_LEN, interleaved_lich, n_enc, setup_frame + 2);
 
     // "Transmit" LICH
     printf ("Setup Frame:    ");
     print_char_hex(setup_frame, 48);
 	printf("\n");
 
+    m17_output_frame(setup_frame, 48);
+
 }
 
 
@@ -447,19 +526,20 @@ void m17_transmit_sub_frame(char *_payload)
 
 	// Create Sub Frame - SYNC (2 Bytes), LICH Chunk (12 Bytes) and Payload (34 Bytes) 
     unsigned char sub_frame[48];
-    memset(&sub_frame[0], 0, sizeof(sub_frame));
 
-    // Add SYNC and Type 4 Payload
+    // Add SYNC and Randomized Type 4 Payload
     sub_frame[0] = (uint64_t)((m17_sync1 >> 8) & 0xFF);
     sub_frame[1] = (uint64_t)((m17_sync1) & 0xFF);
-    memcpy(sub_frame + 2, enc_lich_chunk, enc_lich_chunk_len);
-    memcpy(sub_frame + 14, interleaved_sub_frame_chunk, n_enc);
+    randomizer_encode(0, 12, enc_lich_chunk, enc_lich_chunk_len, sub_frame + 2);
+    randomizer_encode(12, RANDOMIZER_LEN - 12, interleaved_sub_frame_chunk, n_enc, sub_frame + 14);
 
 	// "Transmit" Sub Frame
     printf ("Sub Frame (%02d): ", m17_fn);
     print_char_hex(sub_frame, 48);
 	printf("\n");
 
+    m17_output_frame(sub_frame, 48);
+
 	// Increment Frame Number
 	m17_fn++;
 }
@@ -471,20 +551,37 @@ void transmit_voice_stream()
     m17_type.PacketStream = M17_STREAMMODE;
     m17_type.DataType = M17_VOICE;
 
-    // "Transmit" Setup Frame
+    // "Transmit" Preamble and Setup Frame
+    m17_transmit_preamble();
     m17_transmit_setup_frame();
 
     // Encryption Variables
-    struct AES_ctx ctx;
-    char iv[16];
+    struct AES_ctx *ctx;
+    struct AES_keystream ks;
+    struct scrambler_ctx sc;
 
     // Setup Encryption
     if (m17_type.EncryptionType == M17_ENC_AES)
     {
         printf("AES Encryption Required.\n");
-        // Load Key & Nonce
-        aes256ctr_set_key(&ctx, aes_key);
-        memcpy(iv, m17_nonce, 14);
+        // Get Key & Load Nonce, precompute keystream for the first frames.
+        if ( (ctx = aes_keystore_get(aes_keys, aes_key_id)) == NULL ) {
+
+            printf("Error AES Key ID %u not found.\n", aes_key_id);
+            exit(1);
+        }
+        aes256ctr_keystream_init(&ks, ctx, m17_nonce, m17_fn);
+        aes256ctr_keystream_fill(&ks);
+    }
+    else if (m17_type.EncryptionType == M17_ENC_SCRAMBLE)
+    {
+        printf("Scrambler Encryption Required.\n");
+        // Load Seed for Sub Type.
+        if (scrambler_init(&sc, m17_type.EncryptionSubType, scramble_key) != 0) {
+
+            printf("Error invalid Scrambler Seed.\n");
+            exit(1);
+        }
     }
 
 
@@ -495,17 +592,22 @@ void transmit_voice_stream()
     void *codec2 = codec2_create(mode);
     codec2_set_natural_or_gray(codec2, 1); // Set Gray
 
-    short *buf;
     unsigned char *bits;
     int nsam, nbit, nbyte;
 
     nsam = codec2_samples_per_frame(codec2);    // 160
     nbit = codec2_bits_per_frame(codec2);       // 64
-    buf = (short*)malloc(nsam*sizeof(short));   // 320 Bytes
     nbyte = (nbit + 7) / 8;                     // 8
 
     bits = (unsigned char*)malloc(nbyte*sizeof(char));
 
+#if OFFLINE_ENCODE_THREADS
+    // Each segment is encoded by its own Codec2 Object, this one only gave the frame sizes.
+    codec2_destroy(codec2);
+#else
+    short *buf = (short*)malloc(nsam*sizeof(short));   // 320 Bytes
+#endif
+
     // Load file.
     if ( (fptr = fopen("raw/hts1a.raw","rb")) == NULL ) {
 
@@ -518,10 +620,53 @@ void transmit_voice_stream()
     // Used to alternate writing to the first half or second half of codec2_3200_payload. codec2_encode (3200) returns 8 bytes at time.
     uint16_t write_count = 0;
 
+#if OFFLINE_ENCODE_THREADS
+    // Read whole File and encode it in segments, one per thread.
+    long file_len;
+
+    if (fseek(fptr, 0, SEEK_END) != 0 || (file_len = ftell(fptr)) < 0 || fseek(fptr, 0, SEEK_SET) != 0) {
+
+        printf("Error reading audio file.\n");
+        exit(1);
+    }
+
+    int nframes = file_len / (nsam*sizeof(short));
+    short *speech = (short*)malloc((size_t)nframes*nsam*sizeof(short));
+    unsigned char *stream = (unsigned char*)malloc((size_t)nframes*nbyte);
+
+    if (nframes > 0 && (speech == NULL || stream == NULL)) {
+
+        printf("Error allocating audio buffers.\n");
+        exit(1);
+    }
+
+    nframes = fread(speech, nsam*sizeof(short), nframes, fptr);
+
+    // The report runs a second, sequential encode of the whole file.
+    struct codec2_segment_report report;
+
+    if (codec2_encode_segmented(mode, 1, stream, speech, nframes, OFFLINE_ENCODE_THREADS, CODEC2_SEGMENT_WARMUP,
+                                OFFLINE_ENCODE_REPORT ? &report : NULL) < 0) {
+
+        printf("Error encoding audio file.\n");
+        exit(1);
+    }
+
+    if (OFFLINE_ENCODE_REPORT)
+        printf("Encoded %d frames in %d segments, %d frames (%ld bits) differ from sequential encode.\n",
+               nframes, report.nsegments, report.frames_differ, report.bits_differ);
+
+    free(speech);
+
+    for (int f = 0; f < nframes; f++) {
+
+        memcpy(bits, stream + f*nbyte, nbyte);
+#else
     // Read File
     while(fread(buf, sizeof(short), nsam, fptr) == (size_t)nsam) {
 
         codec2_encode(codec2, bits, buf);
+#endif
 
         if (!(write_count % 2))
         {
@@ -536,25 +681,238 @@ void transmit_voice_stream()
 
             if (m17_type.EncryptionType == M17_ENC_AES)
             {
-                // Add current Frame Number to IV and encrypt Payload
-                iv[14] = (uint64_t)((m17_fn >> 8) & 0xFF);
-                iv[15] = (uint64_t)((m17_fn) & 0xFF);
-                aes256ctr_xcrypt(&ctx, codec2_3200_payload, iv);
+                // Encrypt Payload with precomputed keystream for current Frame Number
+                aes256ctr_keystream_xcrypt(&ks, codec2_3200_payload, m17_fn);
+            }
+            else if (m17_type.EncryptionType == M17_ENC_SCRAMBLE)
+            {
+                // Scramble Payload, sequence continues from previous frame
+                scrambler_xcrypt(&sc, codec2_3200_payload, sizeof(codec2_3200_payload));
             }
 
             // "Transmit" Sub Frame
             m17_transmit_sub_frame(codec2_3200_payload);
+
+            // Top up keystream while waiting for the next frame.
+            if (m17_type.EncryptionType == M17_ENC_AES)
+                aes256ctr_keystream_fill(&ks);
         }
 
         write_count++;
     }
 
+#if OFFLINE_ENCODE_THREADS
+    free(stream);
+#else
+    free(buf);
     codec2_destroy(codec2);
+#endif
 
 
 }
 
 
+/* 
+ * "Transmit" Packet Frames encoded with LDPC. !! OUT OF SPEC !!
+ * 
+ * _chunks         :   chunks and Control bytes of all Packet Frames [size: _n_frames x M17_PACKET_FRAME_LEN]
+ * _n_frames       :   number of chunks
+ * _ldpc           :   ldpc object (HRA_112_112)
+ * 
+ * Chunks are split into codewords (14 Bytes data, 28 Bytes encoded) that run on across Packet Frames.
+ * Last codeword and last Frame are zero padded. No interleaver, the code spreads each bit over its checks.
+ */
+void m17_transmit_packet_ldpc(unsigned char *_chunks, unsigned int _n_frames, ldpc _ldpc)
+{
+    unsigned int dec_len = ldpc_get_data_bits(_ldpc) / 8;
+    unsigned int enc_len = ldpc_get_code_bits(_ldpc) / 8;
+
+    unsigned int chunks_len = _n_frames*M17_PACKET_FRAME_LEN;
+    unsigned int n_codewords = (chunks_len + dec_len - 1) / dec_len;
+    unsigned int n_tx_frames = (n_codewords*enc_len + RANDOMIZER_LEN - 1) / RANDOMIZER_LEN;
+
+    unsigned char data[n_codewords*dec_len];
+    unsigned char encoded[n_tx_frames*RANDOMIZER_LEN];
+
+    memset(data, 0, sizeof(data));
+    memset(encoded, 0, sizeof(encoded));
+    memcpy(data, _chunks, chunks_len);
+
+    for (unsigned int c = 0; c < n_codewords; c++)
+        ldpc_encode(_ldpc, data + c*dec_len, encoded + c*enc_len);
+
+    // Create and "Transmit" Packet Frames - SYNC (2 Bytes) and Randomized Type 4 Payload (46 Bytes)
+    unsigned char packet_frame[48];
+
+    packet_frame[0] = (uint64_t)((m17_sync2 >> 8) & 0xFF);
+    packet_frame[1] = (uint64_t)((m17_sync2) & 0xFF);
+
+    for (unsigned int f = 0; f < n_tx_frames; f++)
+    {
+        randomizer_encode(0, RANDOMIZER_LEN, encoded + f*RANDOMIZER_LEN, RANDOMIZER_LEN, packet_frame + 2);
+
+        printf ("Packet Frame (%02d): ", f);
+        print_char_hex(packet_frame, 48);
+        printf("\n");
+
+        m17_output_frame(packet_frame, 48);
+    }
+}
+
+/* 
+ * "Transmit" a Packet. Payload and CRC are split into chunks and all Packet Frames are built first,
+ * then encoded and interleaved as one block.
+ * 
+ * _payload        :   packet payload
+ * _len            :   payload length (number of bytes, upto M17_PACKET_MAX_LEN)
+ * _fec            :   fec object (CONV_25_P7_8)
+ * _il             :   interleaver object
+ * _ldpc           :   ldpc object, encodes with LDPC instead of _fec and _il if not NULL
+ */
+void m17_transmit_packet(unsigned char *_payload, unsigned int _len, fec _fec, interleaver _il, ldpc _ldpc)
+{
+    // Add CRC to Payload
+    unsigned int packet_len = _len + 2;
+    unsigned char packet[M17_PACKET_MAX_FRAMES*M17_PACKET_CHUNK_LEN];
+
+    uint16_t packet_crc = crc16_m17(_payload, _len);
+
+    memcpy(packet, _payload, _len);
+    packet[_len] = (uint64_t)((packet_crc >> 8) & 0xFF);
+    packet[_len + 1] = (uint64_t)((packet_crc) & 0xFF);
+
+    // Split into chunks, add Control byte
+    unsigned int n_frames = (packet_len + M17_PACKET_CHUNK_LEN - 1) / M17_PACKET_CHUNK_LEN;
+    unsigned char packet_chunks[n_frames][M17_PACKET_FRAME_LEN];
+    memset(packet_chunks, 0, sizeof(packet_chunks));
+
+    for (unsigned int f = 0; f < n_frames; f++)
+    {
+        unsigned int chunk_len = packet_len - f*M17_PACKET_CHUNK_LEN;
+        if (chunk_len > M17_PACKET_CHUNK_LEN) chunk_len = M17_PACKET_CHUNK_LEN;
+
+        memcpy(packet_chunks[f], packet + f*M17_PACKET_CHUNK_LEN, chunk_len);
+
+        if (f == n_frames - 1)
+            packet_chunks[f][M17_PACKET_CHUNK_LEN] = M17_PACKET_EOF | (chunk_len << 2);
+        else
+            packet_chunks[f][M17_PACKET_CHUNK_LEN] = f << 2;
+    }
+
+    if (_ldpc != NULL)
+    {
+        m17_transmit_packet_ldpc(packet_chunks[0], n_frames, _ldpc);
+        return;
+    }
+
+    // Encode Packet Frames - Viterbi R=1/2 K=5 Punctured 7/8
+    unsigned int n_enc = get_convolutional_msg_len(_fec, M17_PACKET_FRAME_LEN);
+    unsigned char encoded_chunks[n_frames][n_enc];
+    unsigned char interleaved_chunks[n_frames][n_enc];
+
+    convolutional_punctured_encode_batch(_fec, M17_PACKET_FRAME_LEN, packet_chunks[0], encoded_chunks[0], n_frames, NULL); // Return 45 Bytes. Padded to 46 Bytes by randomizer.
+    interleaver_encode_batch(_il, encoded_chunks[0], interleaved_chunks[0], n_frames, NULL);
+
+    // Create and "Transmit" Packet Frames - SYNC (2 Bytes) and Randomized Type 4 Payload (46 Bytes)
+    unsigned char packet_frame[48];
+
+    packet_frame[0] = (uint64_t)((m17_sync2 >> 8) & 0xFF);
+    packet_frame[1] = (uint64_t)((m17_sync2) & 0xFF);
+
+    for (unsigned int f = 0; f < n_frames; f++)
+    {
+        randomizer_encode(0, RANDOMIZER_LEN, interleaved_chunks[f], n_enc, packet_frame + 2);
+
+        printf ("Packet Frame (%02d): ", f);
+        print_char_hex(packet_frame, 48);
+        printf("\n");
+
+        m17_output_frame(packet_frame, 48);
+    }
+}
+
+
+void transmit_packet_data()
+{
+    // Set Message Options
+    m17_type.PacketStream = M17_PACKETMODE;
+    m17_type.DataType = M17_DATA;
+    m17_type.EncryptionType = M17_NONE; // TODO - Packet Mode Encryption.
+    m17_type.EncryptionSubType = M17_NONE;
+
+    FILE *fptr;
+
+    // Load file. Called after the voice stream, so errors only skip Packet Mode and main still flushes and closes its outputs.
+    if ( (fptr = fopen(PACKET_FILE,"rb")) == NULL ) {
+
+        printf("Warning: Error opening packet file, no packets transmitted.\n");
+        return;
+    }
+
+    long data_len = -1;
+
+    if (fseek(fptr, 0, SEEK_END) == 0)
+        data_len = ftell(fptr);
+
+    if (data_len < 0 || fseek(fptr, 0, SEEK_SET) != 0) {
+
+        printf("Warning: Error reading packet file, no packets transmitted.\n");
+        fclose(fptr);
+        return;
+    }
+
+    unsigned char *data = (unsigned char*)malloc(data_len ? data_len : 1);
+
+    if (data == NULL || fread(data, 1, data_len, fptr) != (size_t)data_len) {
+
+        printf("Warning: Error reading packet file, no packets transmitted.\n");
+        free(data);
+        fclose(fptr);
+        return;
+    }
+
+    fclose(fptr);
+
+    // "Transmit" Preamble and Setup Frame
+    m17_transmit_preamble();
+    m17_transmit_setup_frame();
+
+    // Create fec and interleaver objects once, reused for every Packet.
+    fec q1 = convolutional_punctured_create(CONV_25_P7_8);
+    interleaver q2 = interleaver_create(get_convolutional_msg_len(q1, M17_PACKET_FRAME_LEN));
+
+#if PACKET_LDPC
+    ldpc q3 = ldpc_create(LDPC_CODE(HRA_112_112));
+
+    if (q3 == NULL) {
+
+        printf("Warning: Error creating LDPC encoder, no packets transmitted.\n");
+        convolutional_punctured_destroy(q1);
+        interleaver_destroy(q2);
+        free(data);
+        return;
+    }
+#else
+    ldpc q3 = NULL;
+#endif
+
+    // Split data into Packets. !! OUT OF SPEC !! Spec sends one Packet per Setup Frame.
+    for (long offset = 0; offset < data_len; offset += M17_PACKET_MAX_LEN)
+    {
+        unsigned int len = (data_len - offset) > M17_PACKET_MAX_LEN ? M17_PACKET_MAX_LEN : (data_len - offset);
+
+        m17_transmit_packet(data + offset, len, q1, q2, q3);
+    }
+
+    // Clean up
+    convolutional_punctured_destroy(q1);
+    interleaver_destroy(q2);
+    if (q3 != NULL)
+        ldpc_destroy(q3);
+    free(data);
+}
+
+
 int main (void) {
 
 	printf ("Program Started.\n");
@@ -564,9 +922,54 @@ int main (void) {
     m17_type.EncryptionSubType = M17_NONE;
     m17_type.Reserved = M17_NONE;
 
+    // Load AES Keys.
+    aes_keys = aes_keystore_create(1024);
+    aes_keystore_add(aes_keys, aes_key_id, aes_key);
+
+    // Create Modulator and open Baseband File.
+    m17_mod = modulator_create();
+
+#if BASEBAND_OUTPUT
+    if ( (baseband_fptr = fopen(BASEBAND_FILE,"wb")) == NULL ) {
+
+        printf("Error opening baseband file.\n");
+        exit(1);
+    }
+#endif
+
+#if CAPTURE_OUTPUT
+    if ( (capture_fptr = fopen(CAPTURE_FILE,"wb")) == NULL ) {
+
+        printf("Error opening capture file.\n");
+        exit(1);
+    }
+#endif
+
     transmit_voice_stream();
 
-	
+#if PACKET_TRANSMIT
+    transmit_packet_data();
+#endif
+
+#if BASEBAND_OUTPUT
+    // Flush last symbols out of the RRC filter.
+    float tail[RRC_DELAY*M17_SPS];
+    short baseband[RRC_DELAY*M17_SPS];
+    modulator_flush(m17_mod, tail);
+
+    for (int i = 0; i < RRC_DELAY*M17_SPS; i++)
+        baseband[i] = tail[i] * BASEBAND_SCALE;
+
+    fwrite(baseband, sizeof(short), RRC_DELAY*M17_SPS, baseband_fptr);
+    fclose(baseband_fptr);
+#endif
+
+#if CAPTURE_OUTPUT
+    fclose(capture_fptr);
+#endif
+
+    modulator_destroy(m17_mod);
+    aes_keystore_destroy(aes_keys);
 
 	printf ("Program Finished.\n");
 }
@@ -0,0 +1,208 @@
+/* Modem Library for M17 Protocol */
+
+#ifndef __MODEM2_H__
+#define __MODEM2_H__
+
+#include <stdint.h>
+
+/****
+
+		Global Variables
+
+****/
+
+/* M17 4FSK Baseband */
+#define M17_SYMBOL_RATE	4800
+#define M17_SAMPLE_RATE	48000
+#define M17_SPS			10			// Samples per symbol
+
+/* Root Raised Cosine Filter */
+#define RRC_ALPHA		0.5f		// Roll-off factor
+#define RRC_SPAN		8			// Filter length (number of symbols)
+#define RRC_DELAY		(RRC_SPAN/2)	// Filter delay (number of symbols)
+#define RRC_TAPS		(RRC_SPAN*M17_SPS + 1)
+
+/* 
+ * Compute Root Raised Cosine filter taps.
+ * 
+ * _h              :   filter taps [size: 1 x RRC_TAPS]
+ * 
+ * Taps are normalised to unit energy.
+ */
+void rrc_design(float *_h);
+
+
+
+/****
+
+		4FSK Symbol Mapper
+
+****/
+
+/* 
+ * Maps bytes to 4FSK symbols (4 per byte, most significant dibit first).
+ * 
+ * _msg            :   message
+ * _msg_len        :   message length (number of bytes)
+ * _sym            :   symbols [size: 1 x 4*_msg_len]
+ * 
+ * Dibit mapping: 01 = +3, 00 = +1, 10 = -1, 11 = -3.
+ */
+void fsk4_map(unsigned char *_msg, unsigned int _msg_len, float *_sym);
+
+
+
+/****
+
+		4FSK Modulator - Polyphase RRC Interpolator
+
+****/
+
+typedef struct modulator_s * modulator;
+
+/* 
+ * Create modulator object.
+ */
+modulator modulator_create(void);
+
+/* 
+ * Destroy modulator object.
+ */
+void modulator_destroy(modulator _q);
+
+/* 
+ * Clear filter history.
+ */
+void modulator_reset(modulator _q);
+
+/* 
+ * Returns number of baseband samples produced for a message (number of bytes).
+ */
+unsigned int modulator_get_samples_len(unsigned int _msg_len);
+
+/* 
+ * Modulate a block of bytes. Filter state is kept between calls.
+ * 
+ * _q              :   modulator object
+ * _msg            :   message
+ * _msg_len        :   message length (number of bytes)
+ * _samples        :   baseband samples [size: 1 x 4*M17_SPS*_msg_len]
+ * 
+ * Output has unity DC gain (a run of +3 symbols gives +3), delayed by RRC_DELAY symbols.
+ */
+void modulator_execute(modulator _q, unsigned char *_msg, unsigned int _msg_len, float *_samples);
+
+/* 
+ * Push RRC_DELAY zero symbols to flush the last symbols out of the filter.
+ * 
+ * _q              :   modulator object
+ * _samples        :   baseband samples [size: 1 x RRC_DELAY*M17_SPS]
+ */
+void modulator_flush(modulator _q, float *_samples);
+
+
+
+/****
+
+		4FSK Demodulator - Matched RRC Filter and Gardner Timing Recovery
+
+****/
+
+typedef struct demodulator_s * demodulator;
+
+/* 
+ * Create demodulator object.
+ */
+demodulator demodulator_create(void);
+
+/* 
+ * Destroy demodulator object.
+ */
+void demodulator_destroy(demodulator _q);
+
+/* 
+ * Clear filter history, timing and gain.
+ */
+void demodulator_reset(demodulator _q);
+
+/* 
+ * Converts a symbol (nominally +/-1, +/-3) to 2 LLRs, most significant bit first.
+ * 
+ * _sym            :   symbol
+ * _llr            :   LLRs [size: 1 x 2]
+ * 
+ * LLR > 0 favours 1, as used by convolutional_punctured_decode_soft.
+ */
+void fsk4_soft_demap(float _sym, signed char *_llr);
+
+/* 
+ * Demodulate a block of baseband samples. Filter, timing and gain state are kept between calls.
+ * 
+ * _q              :   demodulator object
+ * _samples        :   baseband samples (48000Hz)
+ * _n              :   number of samples
+ * _llr            :   LLRs [size: 1 x 2*(_n/M17_SPS + 1)]
+ * 
+ * Returns number of LLRs written (2 per symbol).
+ */
+unsigned int demodulator_execute(demodulator _q, float *_samples, unsigned int _n, signed char *_llr);
+
+
+
+/****
+
+		Frame Synchronizer - Sync Burst search in packed bit streams
+
+****/
+
+#define FRAMESYNC_FRAME_LEN 48		// Frame length including Sync Burst (number of bytes)
+#define FRAMESYNC_MAX_MISS 2		// Missed Sync Bursts before lock is dropped
+
+typedef struct framesync_s * framesync;
+
+/* 
+ * Called for each frame found.
+ * 
+ * _frame          :   frame, byte aligned, starting with the Sync Burst [size: 1 x FRAMESYNC_FRAME_LEN]
+ * _sync           :   index of matching Sync Burst in the list given to framesync_create
+ * _bit_offset     :   position of frame in the input (number of bits)
+ * _userdata       :   user data given to framesync_execute/framesync_file
+ */
+typedef void (*framesync_callback)(unsigned char *_frame, unsigned int _sync, unsigned long _bit_offset, void *_userdata);
+
+/* 
+ * Create frame synchronizer.
+ * 
+ * _syncs          :   Sync Bursts to search for (up to 4)
+ * _num_syncs      :   number of Sync Bursts
+ * _max_errors     :   bit errors tolerated in each Sync Burst
+ */
+framesync framesync_create(const uint16_t *_syncs, unsigned int _num_syncs, unsigned int _max_errors);
+
+/* 
+ * Destroy frame synchronizer.
+ */
+void framesync_destroy(framesync _q);
+
+/* 
+ * Find frames in a packed bit stream (most significant bit first) at any bit offset.
+ * 
+ * _q              :   frame synchronizer
+ * _data           :   bit stream
+ * _len            :   bit stream length (number of bytes)
+ * _callback       :   called for each frame
+ * _userdata       :   passed to _callback
+ * 
+ * Returns number of frames found. A Sync Burst is only accepted when the following frame also starts with one,
+ * after that only the expected position is checked until FRAMESYNC_MAX_MISS Sync Bursts are missed.
+ */
+unsigned long framesync_execute(framesync _q, const unsigned char *_data, unsigned long _len, framesync_callback _callback, void *_userdata);
+
+/* 
+ * Find frames in a capture file. File is memory mapped and passed to framesync_execute.
+ * 
+ * Returns number of frames found, -1 if the file could not be read.
+ */
+long framesync_file(framesync _q, const char *_path, framesync_callback _callback, void *_userdata);
+
+#endif
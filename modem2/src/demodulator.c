@@ -0,0 +1,148 @@
+/****
+		4FSK Demodulator - Matched RRC Filter, Gardner Timing Recovery and Soft (LLR) Output.
+****/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "modem2.h"
+
+
+// Matched filter length, RRC_TAPS padded with zeros to a multiple of DEMOD_LANES.
+#define DEMOD_LANES 8
+#define DEMOD_TAPS (((RRC_TAPS + DEMOD_LANES - 1) / DEMOD_LANES) * DEMOD_LANES)
+
+// Input history. Must cover the matched filter plus the span from the mid point to the newest sample.
+#define DEMOD_HIST_LEN 128
+#define DEMOD_HIST_MASK (DEMOD_HIST_LEN - 1)
+
+#define DEMOD_TIMING_GAIN 0.02f		// Gardner loop gain (samples per unit error)
+#define DEMOD_TIMING_LIMIT 1.0f		// Maximum timing correction per symbol (samples)
+#define DEMOD_AGC_RATE 0.01f		// AGC averaging (per symbol)
+#define DEMOD_LLR_SCALE 42.0f		// LLR per unit distance from the decision threshold
+
+// demodulator object
+struct demodulator_s {
+    // Matched filter taps, oldest sample first. Zero padded at the start.
+    float h[DEMOD_TAPS];
+
+    // Input history indexed by sample number, stored twice so any DEMOD_TAPS window is contiguous.
+    float x[2*DEMOD_HIST_LEN];
+    unsigned long n;					// Sample number of next input.
+
+    double t_next;						// Sample number (fractional) of next symbol strobe.
+    float y_prev;						// Previous symbol strobe.
+    float level;						// Average |symbol| for AGC. Ideal symbols average 2.
+};
+
+
+demodulator demodulator_create(void)
+{
+    demodulator q = (demodulator) malloc(sizeof(struct demodulator_s));
+
+    // RRC is symmetric, only the zero padding has to move to the oldest end.
+    memset(q->h, 0, sizeof(q->h));
+    rrc_design(q->h + DEMOD_TAPS - RRC_TAPS);
+
+    demodulator_reset(q);
+
+    return q;
+}
+
+void demodulator_destroy(demodulator _q)
+{
+    free(_q);
+}
+
+void demodulator_reset(demodulator _q)
+{
+    memset(_q->x, 0, sizeof(_q->x));
+    _q->n = 0;
+
+    // First strobe once the filter has filled. Timing loop pulls it onto the symbol centre.
+    _q->t_next = DEMOD_TAPS;
+    _q->y_prev = 0;
+    _q->level = 0;
+}
+
+// Matched filter output at sample number _m. Only evaluated where the timing loop needs it,
+// 4 points per symbol instead of M17_SPS.
+static float demodulator_filter(demodulator _q, unsigned long _m)
+{
+    float acc[DEMOD_LANES] = { 0 };
+    const float *x = &_q->x[(_m - DEMOD_TAPS + 1) & DEMOD_HIST_MASK];
+
+    // Independent partial sums so the loop vectorises without reassociating floats.
+    for (int j = 0; j < DEMOD_TAPS; j += DEMOD_LANES)
+        for (int l = 0; l < DEMOD_LANES; l++)
+            acc[l] += _q->h[j + l] * x[j + l];
+
+    float y = 0;
+    for (int l = 0; l < DEMOD_LANES; l++)
+        y += acc[l];
+
+    return y;
+}
+
+// Linear interpolation of matched filter output at fractional sample number _t.
+static float demodulator_interp(demodulator _q, double _t)
+{
+    unsigned long i = (unsigned long)_t;
+    float f = (float)(_t - i);
+    float y0 = demodulator_filter(_q, i);
+    float y1 = demodulator_filter(_q, i + 1);
+
+    return y0 + f * (y1 - y0);
+}
+
+static signed char llr_clip(float _v)
+{
+    return _v < -127.0f ? -127 : (_v > 127.0f ? 127 : (signed char)_v);
+}
+
+void fsk4_soft_demap(float _sym, signed char *_llr)
+{
+    // MSB is 1 for negative symbols, LSB is 1 for outer symbols (+/-3).
+    _llr[0] = llr_clip(-DEMOD_LLR_SCALE * _sym);
+    _llr[1] = llr_clip(DEMOD_LLR_SCALE * (fabsf(_sym) - 2.0f));
+}
+
+unsigned int demodulator_execute(demodulator _q, float *_samples, unsigned int _n, signed char *_llr)
+{
+    unsigned int num_llr = 0;
+
+    for (unsigned int k = 0; k < _n; k++)
+    {
+        _q->x[_q->n & DEMOD_HIST_MASK] = _samples[k];
+        _q->x[(_q->n & DEMOD_HIST_MASK) + DEMOD_HIST_LEN] = _samples[k];
+        _q->n++;
+
+        // Strobe once both samples around t_next are available.
+        while (_q->t_next + 1.0 < (double)_q->n)
+        {
+            float y = demodulator_interp(_q, _q->t_next);
+            float mid = demodulator_interp(_q, _q->t_next - M17_SPS / 2.0);
+
+            // AGC. Ideal 4FSK symbols (+/-1, +/-3) average |2|.
+            _q->level += DEMOD_AGC_RATE * (fabsf(y) - _q->level);
+            float gain = _q->level > 1e-6f ? 2.0f / _q->level : 0.0f;
+
+            // Gardner timing error, normalised to unit symbol spacing.
+            float e = (y - _q->y_prev) * mid * gain * gain;
+            float dt = DEMOD_TIMING_GAIN * e;
+
+            if (dt > DEMOD_TIMING_LIMIT) dt = DEMOD_TIMING_LIMIT;
+            if (dt < -DEMOD_TIMING_LIMIT) dt = -DEMOD_TIMING_LIMIT;
+
+            _q->t_next += M17_SPS - dt;
+            _q->y_prev = y;
+
+            fsk4_soft_demap(y * gain, &_llr[num_llr]);
+            num_llr += 2;
+        }
+    }
+
+    return num_llr;
+}
@@ -0,0 +1,280 @@
+/****
+		Frame Synchronizer - Finds Sync Bursts at any bit offset in a packed bit stream. !!! mmap() Not Portable !!!
+****/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>		// Not Portable
+#include <unistd.h>		// Not Portable
+#include <sys/mman.h>	// Not Portable
+#include <sys/stat.h>	// Not Portable
+
+#include "modem2.h"
+
+
+#define FRAMESYNC_MAX_SYNCS 4
+
+// framesync object
+struct framesync_s {
+    uint16_t syncs[FRAMESYNC_MAX_SYNCS];
+    unsigned int num_syncs;
+    unsigned int max_errors;		// Bit errors tolerated in a Sync Burst.
+};
+
+
+static uint64_t load_be64(const unsigned char *_p)
+{
+    uint64_t w = 0;
+
+    for (int i = 0; i < 8; i++)
+        w = (w << 8) | _p[i];
+
+    return w;
+}
+
+// 16 bits starting at bit _pos (most significant first).
+static unsigned int get_bits16(const unsigned char *_data, unsigned long _pos)
+{
+    unsigned long b = _pos >> 3;
+    unsigned int s = _pos & 7;
+    uint32_t w = ((uint32_t)_data[b] << 16) | ((uint32_t)_data[b + 1] << 8) | (s ? _data[b + 2] : 0);
+
+    return (w >> (8 - s)) & 0xFFFF;
+}
+
+// Index of Sync Burst within max_errors at bit _pos, or -1. Requires 3 bytes from _pos/8 (2 if byte aligned).
+static int framesync_match(framesync _q, const unsigned char *_data, unsigned long _pos)
+{
+    unsigned int w = get_bits16(_data, _pos);
+
+    for (unsigned int i = 0; i < _q->num_syncs; i++)
+        if ((unsigned int)__builtin_popcount(w ^ _q->syncs[i]) <= _q->max_errors)
+            return i;
+
+    return -1;
+}
+
+// Lanes (one per bit position _base.._base+63, MSB first) where a Sync Burst is within max_errors.
+// Bit sliced: each of the 16 Sync bits is compared for all 64 positions in one word,
+// and the mismatches are summed in 5 bit-plane counters.
+static uint64_t framesync_search64(framesync _q, const unsigned char *_data, unsigned long _base)
+{
+    uint64_t w0 = load_be64(_data + (_base >> 3));
+    uint64_t w1 = load_be64(_data + (_base >> 3) + 8);
+    uint64_t x[16];
+    uint64_t found = 0;
+
+    x[0] = w0;
+    for (int j = 1; j < 16; j++)
+        x[j] = (w0 << j) | (w1 >> (64 - j));
+
+    for (unsigned int i = 0; i < _q->num_syncs; i++)
+    {
+        uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+
+        for (int j = 0; j < 16; j++)
+        {
+            // Mismatch where stream bit differs from Sync bit j.
+            uint64_t c = x[j] ^ (((_q->syncs[i] >> (15 - j)) & 1) ? ~0ULL : 0);
+            uint64_t t;
+
+            t = s0 & c; s0 ^= c; c = t;
+            t = s1 & c; s1 ^= c; c = t;
+            t = s2 & c; s2 ^= c; c = t;
+            t = s3 & c; s3 ^= c; c = t;
+            s4 ^= c;
+        }
+
+        // count > max_errors, bit-plane compare against constant.
+        uint64_t planes[5] = { s0, s1, s2, s3, s4 };
+        uint64_t gt = 0, eq = ~0ULL;
+
+        for (int k = 4; k >= 0; k--)
+        {
+            if ((_q->max_errors >> k) & 1) {
+                eq &= planes[k];
+            } else {
+                gt |= eq & planes[k];
+                eq &= ~planes[k];
+            }
+        }
+
+        found |= ~gt;
+    }
+
+    return found;
+}
+
+// Search state. Candidates of the current 64 bit block are kept so each block is only computed once.
+struct framesync_cursor {
+    unsigned long base;			// Bit position of current block.
+    uint64_t found;				// Remaining candidates in block.
+    int valid;
+};
+
+// Next bit position >= _pos with a Sync Burst candidate, or _end if none.
+static unsigned long framesync_search(framesync _q, struct framesync_cursor *_c, const unsigned char *_data, unsigned long _len, unsigned long _pos, unsigned long _end)
+{
+    // Word parallel while 16 bytes can be loaded, then bit by bit.
+    while (_pos < _end && (_pos >> 3) + 16 <= _len)
+    {
+        unsigned long base = _pos & ~63UL;
+
+        if (!_c->valid || _c->base != base)
+        {
+            _c->base = base;
+            _c->found = framesync_search64(_q, _data, base);
+            _c->valid = 1;
+        }
+
+        // Ignore positions before _pos.
+        uint64_t found = _c->found & (~0ULL >> (_pos - base));
+
+        if (found)
+        {
+            unsigned long p = base + __builtin_clzll(found);
+            return p < _end ? p : _end;
+        }
+
+        _pos = base + 64;
+    }
+
+    for (; _pos < _end; _pos++)
+        if (framesync_match(_q, _data, _pos) >= 0)
+            return _pos;
+
+    return _end;
+}
+
+// Copy frame at bit _pos into byte aligned _frame.
+static void framesync_extract(const unsigned char *_data, unsigned long _len, unsigned long _pos, unsigned char *_frame)
+{
+    unsigned long b = _pos >> 3;
+    unsigned int s = _pos & 7;
+
+    if (s == 0) {
+        memcpy(_frame, _data + b, FRAMESYNC_FRAME_LEN);
+        return;
+    }
+
+    for (int i = 0; i < FRAMESYNC_FRAME_LEN; i++)
+    {
+        unsigned char next = (b + i + 1 < _len) ? _data[b + i + 1] : 0;
+        _frame[i] = (_data[b + i] << s) | (next >> (8 - s));
+    }
+}
+
+
+framesync framesync_create(const uint16_t *_syncs, unsigned int _num_syncs, unsigned int _max_errors)
+{
+    framesync q = (framesync) malloc(sizeof(struct framesync_s));
+
+    if (_num_syncs > FRAMESYNC_MAX_SYNCS)
+        _num_syncs = FRAMESYNC_MAX_SYNCS;
+
+    memcpy(q->syncs, _syncs, _num_syncs * sizeof(uint16_t));
+    q->num_syncs = _num_syncs;
+    q->max_errors = _max_errors;
+
+    return q;
+}
+
+void framesync_destroy(framesync _q)
+{
+    free(_q);
+}
+
+unsigned long framesync_execute(framesync _q, const unsigned char *_data, unsigned long _len, framesync_callback _callback, void *_userdata)
+{
+    const unsigned long frame_bits = 8 * FRAMESYNC_FRAME_LEN;
+    unsigned long num_bits = 8 * _len;
+    unsigned long num_frames = 0;
+    unsigned long pos = 0;
+    unsigned char frame[FRAMESYNC_FRAME_LEN];
+    struct framesync_cursor cursor = { 0, 0, 0 };
+
+    // Positions before end hold a whole frame.
+    if (_len < FRAMESYNC_FRAME_LEN)
+        return 0;
+    unsigned long end = num_bits - frame_bits + 1;
+
+    while (pos < end)
+    {
+        // Search. A candidate is only accepted if the next frame also starts with a Sync Burst.
+        pos = framesync_search(_q, &cursor, _data, _len, pos, end);
+
+        if (pos >= end)
+            break;
+
+        if (pos + frame_bits >= end || framesync_match(_q, _data, pos + frame_bits) < 0)
+        {
+            pos++;
+            continue;
+        }
+
+        // Locked. Only the expected position is checked until FRAMESYNC_MAX_MISS Sync Bursts are missed.
+        unsigned int misses = 0;
+
+        while (pos < end && misses < FRAMESYNC_MAX_MISS)
+        {
+            int sync = framesync_match(_q, _data, pos);
+
+            if (sync >= 0)
+            {
+                framesync_extract(_data, _len, pos, frame);
+                _callback(frame, sync, pos, _userdata);
+                num_frames++;
+                misses = 0;
+            }
+            else
+            {
+                misses++;
+            }
+
+            pos += frame_bits;
+        }
+
+        // Lost lock. Search again from just after the last frame that matched.
+        if (misses)
+            pos -= (misses + 1) * frame_bits - 1;
+    }
+
+    return num_frames;
+}
+
+long framesync_file(framesync _q, const char *_path, framesync_callback _callback, void *_userdata)
+{
+    int fd;
+    struct stat st;
+
+    if ( (fd = open(_path, O_RDONLY)) < 0 )
+        return -1;
+
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Nothing to map.
+    if (st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    unsigned char *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return -1;
+
+    // Read ahead, each byte is visited once in order.
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    unsigned long num_frames = framesync_execute(_q, data, st.st_size, _callback, _userdata);
+
+    munmap(data, st.st_size);
+
+    return num_frames;
+}
@@ -0,0 +1,126 @@
+/****
+		4FSK Modulator - Polyphase RRC Interpolator.
+****/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "modem2.h"
+
+
+// Taps per polyphase branch. RRC_TAPS is padded with zeros to a multiple of M17_SPS.
+#define MOD_BRANCH_TAPS ((RRC_TAPS + M17_SPS - 1) / M17_SPS)
+
+// Dibit to symbol.
+static const float fsk4_symbols[4] = { +1.0f, +3.0f, -1.0f, -3.0f };
+
+// modulator object
+struct modulator_s {
+    // Polyphase coefficients [tap][phase]. One symbol produces M17_SPS outputs,
+    // so the inner loop runs across phases and vectorises.
+    float h[MOD_BRANCH_TAPS][M17_SPS];
+
+    // Symbol history, stored twice so the newest MOD_BRANCH_TAPS symbols are always contiguous.
+    float sym[2*MOD_BRANCH_TAPS];
+    unsigned int idx;
+};
+
+
+void fsk4_map(unsigned char *_msg, unsigned int _msg_len, float *_sym)
+{
+    for (unsigned int i = 0; i < _msg_len; i++)
+    {
+        _sym[4*i + 0] = fsk4_symbols[(_msg[i] >> 6) & 0x03];
+        _sym[4*i + 1] = fsk4_symbols[(_msg[i] >> 4) & 0x03];
+        _sym[4*i + 2] = fsk4_symbols[(_msg[i] >> 2) & 0x03];
+        _sym[4*i + 3] = fsk4_symbols[(_msg[i]) & 0x03];
+    }
+}
+
+
+modulator modulator_create(void)
+{
+    modulator q = (modulator) malloc(sizeof(struct modulator_s));
+    float h[MOD_BRANCH_TAPS * M17_SPS];
+
+    memset(h, 0, sizeof(h));
+    rrc_design(h);
+
+    // Scale so each phase has unity DC gain. Constant +3 symbols give +3 at output.
+    float sum = 0;
+    for (int i = 0; i < RRC_TAPS; i++)
+        sum += h[i];
+
+    // Branch p holds taps p, p + M17_SPS, ...
+    for (int k = 0; k < MOD_BRANCH_TAPS; k++)
+        for (int p = 0; p < M17_SPS; p++)
+            q->h[k][p] = h[k*M17_SPS + p] * M17_SPS / sum;
+
+    modulator_reset(q);
+
+    return q;
+}
+
+void modulator_destroy(modulator _q)
+{
+    free(_q);
+}
+
+void modulator_reset(modulator _q)
+{
+    memset(_q->sym, 0, sizeof(_q->sym));
+    _q->idx = 0;
+}
+
+unsigned int modulator_get_samples_len(unsigned int _msg_len)
+{
+    return 4 * M17_SPS * _msg_len;
+}
+
+// Push one symbol and produce M17_SPS samples.
+static void modulator_push(modulator _q, float _sym, float *_samples)
+{
+    float y[M17_SPS];
+
+    // Newest symbol at sym[idx], oldest at sym[idx + MOD_BRANCH_TAPS - 1].
+    _q->idx = (_q->idx == 0) ? MOD_BRANCH_TAPS - 1 : _q->idx - 1;
+    _q->sym[_q->idx] = _sym;
+    _q->sym[_q->idx + MOD_BRANCH_TAPS] = _sym;
+
+    const float *x = &_q->sym[_q->idx];
+
+    for (int p = 0; p < M17_SPS; p++)
+        y[p] = 0;
+
+    for (int k = 0; k < MOD_BRANCH_TAPS; k++)
+        for (int p = 0; p < M17_SPS; p++)
+            y[p] += _q->h[k][p] * x[k];
+
+    memcpy(_samples, y, sizeof(y));
+}
+
+void modulator_execute(modulator _q, unsigned char *_msg, unsigned int _msg_len, float *_samples)
+{
+    float sym[4];
+
+    for (unsigned int i = 0; i < _msg_len; i++)
+    {
+        fsk4_map(&_msg[i], 1, sym);
+
+        for (int s = 0; s < 4; s++)
+        {
+            modulator_push(_q, sym[s], _samples);
+            _samples += M17_SPS;
+        }
+    }
+}
+
+void modulator_flush(modulator _q, float *_samples)
+{
+    for (int s = 0; s < RRC_DELAY; s++)
+    {
+        modulator_push(_q, 0.0f, _samples);
+        _samples += M17_SPS;
+    }
+}
@@ -0,0 +1,37 @@
+/****
+		Root Raised Cosine Filter.
+****/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "modem2.h"
+
+
+void rrc_design(float *_h)
+{
+    const double a = RRC_ALPHA;
+    double energy = 0;
+
+    for (int i = 0; i < RRC_TAPS; i++)
+    {
+        // Time in symbols from filter centre.
+        double t = (double)(i - (RRC_TAPS - 1) / 2) / M17_SPS;
+        double h;
+
+        if (fabs(t) < 1e-9)
+            h = 1.0 - a + 4.0 * a / M_PI;
+        else if (fabs(fabs(t) - 1.0 / (4.0 * a)) < 1e-9)
+            h = a / sqrt(2.0) * ((1.0 + 2.0 / M_PI) * sin(M_PI / (4.0 * a)) + (1.0 - 2.0 / M_PI) * cos(M_PI / (4.0 * a)));
+        else
+            h = (sin(M_PI * t * (1.0 - a)) + 4.0 * a * t * cos(M_PI * t * (1.0 + a))) / (M_PI * t * (1.0 - (4.0 * a * t) * (4.0 * a * t)));
+
+        _h[i] = h;
+        energy += h * h;
+    }
+
+    // Normalise to unit energy.
+    for (int i = 0; i < RRC_TAPS; i++)
+        _h[i] /= sqrt(energy);
+}